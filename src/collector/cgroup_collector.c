@@ -0,0 +1,359 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * cgroup_collector.c - Per-cgroup CPU, memory, I/O and throttling collector
+ * 
+ * Works on the cgroup v2 hierarchy cached by cgroup_tree. Each tick
+ * preads cpu.stat, memory.current, memory.stat, io.stat and the
+ * cpu/memory/io.pressure files of every tracked group through the
+ * descriptors the tree keeps open, turns the counters into rates
+ * against the group's previous sample and publishes the groups that
+ * used the most CPU.
+ */
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <mntent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "cgroup_collector.h"
+#include "cgroup_tree.h"
+#include "psi_collector.h"
+#include "system_stat.h"
+#include "../util/config.h"
+#include "../util/error_handler.h"
+#include "../util/procfs_parse.h"
+#include "../util/time_util.h"
+
+#define CGROUP_REPROBE_SECONDS 30   // Interval between retries of missing stat files
+
+// Sort key of one group; groups are ranked on these, not on whole samples
+typedef struct {
+    double cpu_usage;
+    uint64_t mem_current;
+    int slot;                       // Node slot in the tree
+} rank_key_t;
+
+static struct {
+    bool available;                 // A cgroup2 hierarchy was found and walked
+    bool leaves_only;               // Rank only groups without child groups
+    cgroup_tree_t tree;
+    procfs_buf_t buf;
+    cgroup_info_t *samples;         // This tick's figures, indexed by node slot
+    rank_key_t *keys;
+    int capacity;                   // Entries in samples and keys
+    uint64_t reprobe_ns;            // Next retry of missing stat files
+} cg = { .tree = { .root_fd = -1, .inotify_fd = -1 } };
+
+// Mount point of the cgroup2 hierarchy, or false if there is none
+static bool find_cgroup2_mount(char *path, size_t size)
+{
+    FILE *mounts = setmntent("/proc/self/mounts", "r");
+    if (!mounts) return false;
+
+    bool found = false;
+    struct mntent *m;
+    while ((m = getmntent(mounts)) != NULL) {
+        if (strcmp(m->mnt_type, "cgroup2") == 0 && strlen(m->mnt_dir) < size) {
+            strcpy(path, m->mnt_dir);
+            found = true;
+            break;
+        }
+    }
+    endmntent(mounts);
+    return found;
+}
+
+// pread one stat file of a group into cg.buf
+static bool read_file(const cgroup_node_t *node, cgroup_file_t file)
+{
+    return node->fds[file] != -1 && procfs_read_fd_single(node->fds[file], &cg.buf);
+}
+
+// Parse "key value" lines; keys must include the separating space
+static void parse_keyed(const char *const *keys, const size_t *lens, uint64_t **out, size_t n)
+{
+    procfs_cursor_t cur = procfs_cursor(&cg.buf);
+    procfs_cursor_t line;
+    size_t found = 0;
+
+    while (found < n && procfs_next_line(&cur, &line)) {
+        for (size_t k = 0; k < n; k++) {
+            if (procfs_consume(&line, keys[k], lens[k])) {
+                if (procfs_parse_u64(&line, out[k])) found++;
+                break;
+            }
+        }
+    }
+}
+
+// cpu.stat; the throttling fields only exist with the cpu controller on
+static bool read_cpu_stat(const cgroup_node_t *node, cgroup_counters_t *c)
+{
+    static const char *const keys[] = {
+        "usage_usec ", "nr_periods ", "nr_throttled ", "throttled_usec "
+    };
+    static const size_t lens[] = { 11, 11, 13, 15 };
+
+    if (!read_file(node, CGROUP_FILE_CPU_STAT)) return false;
+    uint64_t *out[] = { &c->usage_usec, &c->nr_periods, &c->nr_throttled, &c->throttled_usec };
+    parse_keyed(keys, lens, out, 4);
+    return true;
+}
+
+// memory.current and the anon and file lines of memory.stat, in bytes
+static bool read_memory(const cgroup_node_t *node, uint64_t *current, uint64_t *anon,
+                        uint64_t *file)
+{
+    static const char *const keys[] = { "anon ", "file " };
+    static const size_t lens[] = { 5, 5 };
+
+    if (!read_file(node, CGROUP_FILE_MEMORY_CURRENT)) return false;
+    procfs_cursor_t cur = procfs_cursor(&cg.buf);
+    if (!procfs_parse_u64(&cur, current)) return false;
+
+    if (read_file(node, CGROUP_FILE_MEMORY_STAT)) {
+        uint64_t *out[] = { anon, file };
+        parse_keyed(keys, lens, out, 2);
+    }
+    return true;
+}
+
+// io.stat: "maj:min rbytes=N wbytes=N rios=N ..." per device, summed
+static bool read_io(const cgroup_node_t *node, cgroup_counters_t *c)
+{
+    if (!read_file(node, CGROUP_FILE_IO_STAT)) return false;
+
+    procfs_cursor_t cur = procfs_cursor(&cg.buf);
+    procfs_cursor_t line;
+    while (procfs_next_line(&cur, &line)) {
+        const char *tok;
+        size_t len;
+        if (!procfs_next_token(&line, &tok, &len)) continue;    // Device number
+
+        while (procfs_next_token(&line, &tok, &len)) {
+            procfs_cursor_t field = { tok, tok + len };
+            uint64_t value;
+            if (procfs_consume(&field, "rbytes=", 7) && procfs_parse_u64(&field, &value)) {
+                c->rbytes += value;
+            } else if (procfs_consume(&field, "wbytes=", 7) && procfs_parse_u64(&field, &value)) {
+                c->wbytes += value;
+            }
+        }
+    }
+    return true;
+}
+
+// "some" stall totals of the cpu, memory and io pressure files
+static bool read_pressure(const cgroup_node_t *node, cgroup_counters_t *c)
+{
+    static const cgroup_file_t files[PSI_RESOURCE_COUNT] = {
+        [PSI_CPU] = CGROUP_FILE_CPU_PRESSURE,
+        [PSI_MEMORY] = CGROUP_FILE_MEMORY_PRESSURE,
+        [PSI_IO] = CGROUP_FILE_IO_PRESSURE
+    };
+
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        psi_line_t some, full;
+        if (!read_file(node, files[r]) || !psi_parse(&cg.buf, &some, &full)) return false;
+        c->psi_usec[r] = some.total;
+    }
+    return true;
+}
+
+// Difference of a counter that may have been reset
+static uint64_t counter_delta(uint64_t now, uint64_t prev)
+{
+    return now >= prev ? now - prev : 0;
+}
+
+// Read one group and turn its counters into rates
+static bool sample_node(cgroup_node_t *node, uint64_t now, int cpus, cgroup_info_t *info)
+{
+    cgroup_counters_t c = { 0 };
+    if (!read_cpu_stat(node, &c)) return false;
+
+    uint64_t current = 0, anon = 0, file = 0;
+    *info = (cgroup_info_t){ 0 };
+    info->has_memory = read_memory(node, &current, &anon, &file);
+    info->mem_current = current / 1024;
+    info->mem_anon = anon / 1024;
+    info->mem_file = file / 1024;
+    info->has_io = read_io(node, &c);
+    info->has_pressure = read_pressure(node, &c);
+
+    if (node->prev_ns != 0 && now > node->prev_ns) {
+        double seconds = (double)(now - node->prev_ns) / NSEC_PER_SEC;
+        uint64_t periods = counter_delta(c.nr_periods, node->prev.nr_periods);
+
+        info->cpu_usage = counter_delta(c.usage_usec, node->prev.usage_usec) /
+                          (seconds * 1e6 * cpus) * 100.0;
+        info->throttled_pct = periods ?
+            counter_delta(c.nr_throttled, node->prev.nr_throttled) * 100.0 / periods : 0.0;
+        info->throttled_rate = counter_delta(c.throttled_usec, node->prev.throttled_usec) /
+                               1000.0 / seconds;
+        info->io_read_rate = counter_delta(c.rbytes, node->prev.rbytes) / 1024.0 / seconds;
+        info->io_write_rate = counter_delta(c.wbytes, node->prev.wbytes) / 1024.0 / seconds;
+
+        double *psi[PSI_RESOURCE_COUNT] = { &info->psi_cpu, &info->psi_memory, &info->psi_io };
+        for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+            *psi[r] = counter_delta(c.psi_usec[r], node->prev.psi_usec[r]) /
+                      (seconds * 1e6) * 100.0;
+        }
+    }
+    node->prev = c;
+    node->prev_ns = now;
+    return true;
+}
+
+// CPU% desc, then memory desc, then slot
+static int compare_keys(const void *a, const void *b)
+{
+    const rank_key_t *ka = a;
+    const rank_key_t *kb = b;
+    if (kb->cpu_usage != ka->cpu_usage) return kb->cpu_usage > ka->cpu_usage ? 1 : -1;
+    if (kb->mem_current != ka->mem_current) return kb->mem_current > ka->mem_current ? 1 : -1;
+    return ka->slot - kb->slot;
+}
+
+// Copy a path, keeping its end when it does not fit
+static void copy_path(char *dst, size_t size, const char *path)
+{
+    size_t len = strlen(path);
+    if (len < size) {
+        memcpy(dst, path, len + 1);
+        return;
+    }
+    size_t keep = size - 4;
+    memcpy(dst, "...", 3);
+    memcpy(dst + 3, path + len - keep, keep + 1);
+}
+
+static bool reserve(int n)
+{
+    if (n <= cg.capacity) return true;
+
+    int capacity = cg.capacity > 0 ? cg.capacity : 64;
+    while (capacity < n) capacity *= 2;
+
+    cgroup_info_t *samples = realloc(cg.samples, capacity * sizeof(cgroup_info_t));
+    if (samples) cg.samples = samples;
+    rank_key_t *keys = realloc(cg.keys, capacity * sizeof(rank_key_t));
+    if (keys) cg.keys = keys;
+    if (!samples || !keys) {
+        log_error("Memory allocation failed");
+        return false;
+    }
+    cg.capacity = capacity;
+    return true;
+}
+
+// Initialize cgroup collector
+bool cgroup_collector_init(void)
+{
+    cg.leaves_only = config_get_bool("cgroup.leaves_only", true);
+
+    char root[PATH_MAX];
+    const char *configured = config_get_string("cgroup.root", "");
+    if (configured[0]) {
+        snprintf(root, sizeof(root), "%s", configured);
+    } else if (!find_cgroup2_mount(root, sizeof(root))) {
+        log_warning("No cgroup2 hierarchy mounted, cgroup panel disabled");
+        return true;
+    }
+
+    // Every group keeps up to CGROUP_FILE_COUNT descriptors open
+    struct rlimit lim;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < lim.rlim_max) {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    if (!procfs_buf_init(&cg.buf, PROCFS_BUF_INITIAL)) {
+        log_error("Memory allocation failed");
+        return false;
+    }
+    if (!cgroup_tree_open(&cg.tree, root)) {
+        log_warning("Failed to walk %s, cgroup panel disabled", root);
+        cgroup_tree_close(&cg.tree);
+        return true;
+    }
+    cg.available = true;
+    cg.reprobe_ns = monotonic_ns() + CGROUP_REPROBE_SECONDS * NSEC_PER_SEC;
+    log_info("Tracking %d cgroups under %s", cg.tree.live, root);
+
+    // Prime the counters so the first published sample has rates
+    cgroup_metrics_t scratch;
+    return cgroup_collector_collect(&scratch);
+}
+
+int cgroup_collector_event_fd(void)
+{
+    return cg.available ? cg.tree.inotify_fd : -1;
+}
+
+bool cgroup_collector_handle_events(void)
+{
+    return cg.available ? cgroup_tree_handle_events(&cg.tree) : true;
+}
+
+// Sample every group and rank the busiest by CPU usage
+bool cgroup_collector_collect(cgroup_metrics_t *metrics)
+{
+    if (!metrics) return false;
+
+    metrics->available = cg.available;
+    metrics->total = 0;
+    metrics->count = 0;
+    if (!cg.available) return true;
+
+    // Creations the event loop has not seen yet
+    cgroup_tree_handle_events(&cg.tree);
+    if (!reserve(cg.tree.count)) return false;
+
+    const system_stat_t *stat = system_stat_get();
+    int cpus = stat && stat->cores.count > 0 ? stat->cores.count : 1;
+    uint64_t now = monotonic_ns();
+    bool reprobe = now >= cg.reprobe_ns;
+    if (reprobe) cg.reprobe_ns = now + CGROUP_REPROBE_SECONDS * NSEC_PER_SEC;
+
+    int ranked = 0;
+    for (int i = 0; i < cg.tree.count; i++) {
+        cgroup_node_t *node = &cg.tree.nodes[i];
+        if (!node->live || node->parent < 0) continue;      // The root is the whole machine
+        if (reprobe) cgroup_tree_reopen_files(&cg.tree, node);
+
+        // A removed group fails its reads until its IN_IGNORED arrives
+        if (!sample_node(node, now, cpus, &cg.samples[i])) continue;
+        metrics->total++;
+
+        if (cg.leaves_only && node->children > 0) continue;
+        cg.keys[ranked++] = (rank_key_t){ cg.samples[i].cpu_usage, cg.samples[i].mem_current, i };
+    }
+
+    qsort(cg.keys, ranked, sizeof(rank_key_t), compare_keys);
+    for (int r = 0; r < ranked && r < MAX_TOP_CGROUPS; r++) {
+        int slot = cg.keys[r].slot;
+        metrics->top[r] = cg.samples[slot];
+        copy_path(metrics->top[r].path, sizeof(metrics->top[r].path), cg.tree.nodes[slot].path);
+        metrics->count++;
+    }
+    return true;
+}
+
+// Clean up cgroup collector resources
+void cgroup_collector_cleanup(void)
+{
+    cgroup_tree_close(&cg.tree);
+    procfs_buf_free(&cg.buf);
+    free(cg.samples);
+    free(cg.keys);
+    cg.samples = NULL;
+    cg.keys = NULL;
+    cg.capacity = 0;
+    cg.available = false;
+}
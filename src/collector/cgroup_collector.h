@@ -0,0 +1,29 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * cgroup_collector.h - Per-cgroup CPU, memory, I/O and throttling collector
+ */
+
+#ifndef CGROUP_COLLECTOR_H
+#define CGROUP_COLLECTOR_H
+
+#include "../include/sysmon.h"
+
+// Initialize the cgroup collector. Without a cgroup2 hierarchy the
+// collector keeps running but reports itself unavailable.
+bool cgroup_collector_init(void);
+
+// Sample every group and rank the busiest by CPU usage
+bool cgroup_collector_collect(cgroup_metrics_t *metrics);
+
+// inotify descriptor that becomes readable when groups are created or
+// removed, or -1 when unavailable
+int cgroup_collector_event_fd(void);
+
+// Apply pending group creations and removals to the cached tree
+bool cgroup_collector_handle_events(void);
+
+// Clean up cgroup collector resources
+void cgroup_collector_cleanup(void);
+
+#endif /* CGROUP_COLLECTOR_H */
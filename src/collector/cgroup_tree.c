@@ -0,0 +1,276 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * cgroup_tree.c - Cached cgroup v2 hierarchy kept current with inotify
+ * 
+ * The hierarchy is walked once at startup. Every group directory gets an
+ * inotify watch for subdirectories created in it, and the stat files of
+ * every group stay open so a tick only preads them. A created directory
+ * is walked on its own; a removed one ends its watch, and the
+ * IN_IGNORED that follows drops the group. Only a queue overflow or a
+ * rename makes the tree walk everything again.
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include "cgroup_tree.h"
+#include "../util/error_handler.h"
+
+#define CGROUP_NODES_INITIAL 64     // Initial slot count
+#define CGROUP_WATCH_MASK (IN_CREATE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR)
+
+static const char *const file_names[CGROUP_FILE_COUNT] = {
+    [CGROUP_FILE_CPU_STAT] = "cpu.stat",
+    [CGROUP_FILE_MEMORY_CURRENT] = "memory.current",
+    [CGROUP_FILE_MEMORY_STAT] = "memory.stat",
+    [CGROUP_FILE_IO_STAT] = "io.stat",
+    [CGROUP_FILE_CPU_PRESSURE] = "cpu.pressure",
+    [CGROUP_FILE_MEMORY_PRESSURE] = "memory.pressure",
+    [CGROUP_FILE_IO_PRESSURE] = "io.pressure"
+};
+
+static cgroup_node_t *find_wd(cgroup_tree_t *tree, int wd)
+{
+    for (int i = 0; i < tree->count; i++) {
+        if (tree->nodes[i].live && tree->nodes[i].wd == wd) return &tree->nodes[i];
+    }
+    return NULL;
+}
+
+static cgroup_node_t *find_path(cgroup_tree_t *tree, const char *path)
+{
+    for (int i = 0; i < tree->count; i++) {
+        if (tree->nodes[i].live && strcmp(tree->nodes[i].path, path) == 0) {
+            return &tree->nodes[i];
+        }
+    }
+    return NULL;
+}
+
+// Open one stat file of a group; a missing file means the controller is off
+static void open_file(cgroup_tree_t *tree, cgroup_node_t *node, cgroup_file_t file)
+{
+    char rel[PATH_MAX];
+    int n = snprintf(rel, sizeof(rel), "%s%s%s", node->path, node->path[0] ? "/" : "",
+                     file_names[file]);
+    if (n < 0 || (size_t)n >= sizeof(rel)) return;
+
+    node->fds[file] = openat(tree->root_fd, rel, O_RDONLY | O_CLOEXEC);
+    if (node->fds[file] == -1 && (errno == EMFILE || errno == ENFILE)) {
+        static bool warned = false;
+        if (!warned) log_warning("Out of descriptors for cgroup stat files");
+        warned = true;
+    }
+}
+
+void cgroup_tree_reopen_files(cgroup_tree_t *tree, cgroup_node_t *node)
+{
+    for (int f = 0; f < CGROUP_FILE_COUNT; f++) {
+        if (node->fds[f] == -1) open_file(tree, node, (cgroup_file_t)f);
+    }
+}
+
+// Take a free slot for path and start watching its directory
+static cgroup_node_t *add_node(cgroup_tree_t *tree, const char *path, int parent)
+{
+    int slot = -1;
+    if (tree->live < tree->count) {
+        for (int i = 0; i < tree->count; i++) {
+            if (!tree->nodes[i].live) {
+                slot = i;
+                break;
+            }
+        }
+    }
+    if (slot == -1) {
+        if (tree->count == tree->capacity) {
+            int capacity = tree->capacity ? tree->capacity * 2 : CGROUP_NODES_INITIAL;
+            cgroup_node_t *nodes = realloc(tree->nodes, capacity * sizeof(cgroup_node_t));
+            if (!nodes) {
+                log_error("Memory allocation failed");
+                return NULL;
+            }
+            tree->nodes = nodes;
+            tree->capacity = capacity;
+        }
+        slot = tree->count++;
+    }
+
+    cgroup_node_t *node = &tree->nodes[slot];
+    *node = (cgroup_node_t){ .parent = parent, .wd = -1 };
+    node->path = strdup(path);
+    if (!node->path) {
+        log_error("Memory allocation failed");
+        return NULL;
+    }
+
+    // Watch before listing, so a child created meanwhile is reported
+    char abs[PATH_MAX];
+    int n = snprintf(abs, sizeof(abs), "%s/%s", tree->root, path);
+    if (n > 0 && (size_t)n < sizeof(abs)) {
+        node->wd = inotify_add_watch(tree->inotify_fd, abs, CGROUP_WATCH_MASK);
+    }
+
+    for (int f = 0; f < CGROUP_FILE_COUNT; f++) {
+        node->fds[f] = -1;
+        open_file(tree, node, (cgroup_file_t)f);
+    }
+
+    node->live = true;
+    tree->live++;
+    if (parent >= 0) tree->nodes[parent].children++;
+    return node;
+}
+
+static void release_node(cgroup_tree_t *tree, cgroup_node_t *node)
+{
+    for (int f = 0; f < CGROUP_FILE_COUNT; f++) {
+        if (node->fds[f] != -1) close(node->fds[f]);
+    }
+    if (node->parent >= 0) tree->nodes[node->parent].children--;
+    free(node->path);
+    node->path = NULL;
+    node->live = false;
+    tree->live--;
+}
+
+// Add the group at path and everything below it. After an event some of
+// the subtree may already be tracked, so existing groups are looked up
+// first; a full walk starts from an empty tree and skips that.
+static void walk(cgroup_tree_t *tree, const char *path, int parent, bool lookup)
+{
+    cgroup_node_t *node = lookup ? find_path(tree, path) : NULL;
+    if (!node) node = add_node(tree, path, parent);
+    if (!node) return;
+    int self = (int)(node - tree->nodes);
+
+    int dfd = openat(tree->root_fd, path[0] ? path : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd == -1) return;
+    DIR *dir = fdopendir(dfd);
+    if (!dir) {
+        close(dfd);
+        return;
+    }
+
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        if (de->d_type != DT_DIR || de->d_name[0] == '.') continue;
+
+        char child[PATH_MAX];
+        int n = snprintf(child, sizeof(child), "%s%s%s", path, path[0] ? "/" : "", de->d_name);
+        if (n < 0 || (size_t)n >= sizeof(child)) continue;
+
+        // The array may move while the subtree is added
+        walk(tree, child, self, lookup);
+    }
+    closedir(dir);
+}
+
+// Drop every group and walk the hierarchy from the top
+static void rescan(cgroup_tree_t *tree)
+{
+    for (int i = 0; i < tree->count; i++) {
+        if (tree->nodes[i].live) release_node(tree, &tree->nodes[i]);
+    }
+    tree->count = 0;
+    tree->resync = false;
+
+    // Watches of directories that still exist are handed back unchanged
+    walk(tree, "", -1, false);
+}
+
+bool cgroup_tree_open(cgroup_tree_t *tree, const char *root)
+{
+    *tree = (cgroup_tree_t){ .root_fd = -1, .inotify_fd = -1 };
+
+    tree->root = strdup(root);
+    if (!tree->root) {
+        log_error("Memory allocation failed");
+        return false;
+    }
+    tree->root_fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (tree->root_fd == -1) {
+        log_error("Failed to open %s: %s", root, strerror(errno));
+        cgroup_tree_close(tree);
+        return false;
+    }
+    tree->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (tree->inotify_fd == -1) {
+        log_error("inotify unavailable: %s", strerror(errno));
+        cgroup_tree_close(tree);
+        return false;
+    }
+
+    rescan(tree);
+    return tree->live > 0;
+}
+
+bool cgroup_tree_handle_events(cgroup_tree_t *tree)
+{
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    for (;;) {
+        ssize_t len = read(tree->inotify_fd, buf, sizeof(buf));
+        if (len <= 0) {
+            if (len == -1 && errno == EINTR) continue;
+            break;
+        }
+
+        for (char *p = buf; p < buf + len; ) {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                tree->resync = true;
+                continue;
+            }
+            if (tree->resync) continue;
+
+            cgroup_node_t *node = find_wd(tree, ev->wd);
+            if (!node) continue;
+
+            if (ev->mask & IN_IGNORED) {
+                // The directory is gone; rmdir only succeeds once the
+                // groups below it are gone too
+                release_node(tree, node);
+            } else if (ev->mask & (IN_MOVED_FROM | IN_MOVED_TO)) {
+                if (ev->mask & IN_ISDIR) tree->resync = true;
+            } else if ((ev->mask & IN_CREATE) && (ev->mask & IN_ISDIR) && ev->len > 0) {
+                char child[PATH_MAX];
+                int n = snprintf(child, sizeof(child), "%s%s%s", node->path,
+                                 node->path[0] ? "/" : "", ev->name);
+                if (n > 0 && (size_t)n < sizeof(child)) {
+                    walk(tree, child, (int)(node - tree->nodes), true);
+                }
+            }
+        }
+    }
+
+    if (tree->resync) {
+        log_warning("cgroup events were lost, walking the hierarchy again");
+        rescan(tree);
+        log_info("cgroup tree walked: %d groups", tree->live);
+    }
+    return true;
+}
+
+void cgroup_tree_close(cgroup_tree_t *tree)
+{
+    for (int i = 0; i < tree->count; i++) {
+        if (tree->nodes[i].live) release_node(tree, &tree->nodes[i]);
+    }
+    free(tree->nodes);
+    free(tree->root);
+    if (tree->inotify_fd != -1) close(tree->inotify_fd);
+    if (tree->root_fd != -1) close(tree->root_fd);
+    *tree = (cgroup_tree_t){ .root_fd = -1, .inotify_fd = -1 };
+}
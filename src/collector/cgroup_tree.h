@@ -0,0 +1,74 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * cgroup_tree.h - Cached cgroup v2 hierarchy kept current with inotify
+ */
+
+#ifndef CGROUP_TREE_H
+#define CGROUP_TREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/sysmon.h"
+
+// Stat files kept open for every group
+typedef enum {
+    CGROUP_FILE_CPU_STAT,           // cpu.stat
+    CGROUP_FILE_MEMORY_CURRENT,     // memory.current
+    CGROUP_FILE_MEMORY_STAT,        // memory.stat
+    CGROUP_FILE_IO_STAT,            // io.stat
+    CGROUP_FILE_CPU_PRESSURE,       // cpu.pressure
+    CGROUP_FILE_MEMORY_PRESSURE,    // memory.pressure
+    CGROUP_FILE_IO_PRESSURE,        // io.pressure
+    CGROUP_FILE_COUNT
+} cgroup_file_t;
+
+// Cumulative counters of one group at its last sample
+typedef struct {
+    uint64_t usage_usec;            // cpu.stat
+    uint64_t nr_periods;
+    uint64_t nr_throttled;
+    uint64_t throttled_usec;
+    uint64_t rbytes;                // io.stat, summed over devices
+    uint64_t wbytes;
+    uint64_t psi_usec[PSI_RESOURCE_COUNT];  // "some" stall totals of *.pressure
+} cgroup_counters_t;
+
+// One group of the hierarchy
+typedef struct {
+    char *path;                     // Relative to the mount; "" for the root
+    bool live;                      // Slot in use
+    int parent;                     // Slot of the parent, -1 for the root
+    int children;                   // Live child groups
+    int wd;                         // inotify watch descriptor, or -1
+    int fds[CGROUP_FILE_COUNT];     // Open stat files, -1 where absent
+    cgroup_counters_t prev;         // Counters at prev_ns
+    uint64_t prev_ns;               // Time of the last sample, or 0
+} cgroup_node_t;
+
+typedef struct {
+    char *root;                     // Mount point of the hierarchy
+    int root_fd;                    // Directory descriptor of the mount
+    int inotify_fd;                 // Watches every group directory
+    cgroup_node_t *nodes;           // Slots; removed groups leave free ones
+    int count;                      // Slots used, live or not
+    int capacity;
+    int live;                       // Groups currently tracked
+    bool resync;                    // Events were lost; walk again
+} cgroup_tree_t;
+
+// Walk the hierarchy mounted at root and start watching it
+bool cgroup_tree_open(cgroup_tree_t *tree, const char *root);
+
+// Apply pending inotify events, walking the tree again if any were lost
+bool cgroup_tree_handle_events(cgroup_tree_t *tree);
+
+// Try again to open the stat files a group did not have yet, e.g. after a
+// controller was enabled in its parent
+void cgroup_tree_reopen_files(cgroup_tree_t *tree, cgroup_node_t *node);
+
+// Close every descriptor and release the tree
+void cgroup_tree_close(cgroup_tree_t *tree);
+
+#endif /* CGROUP_TREE_H */
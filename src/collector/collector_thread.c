@@ -0,0 +1,430 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * collector_thread.c - Background metric collection and snapshot handoff
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <poll.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include "collector_thread.h"
+#include "cpu_collector.h"
+#include "memory_collector.h"
+#include "network_collector.h"
+#include "disk_collector.h"
+#include "filesystem_collector.h"
+#include "cgroup_collector.h"
+#include "psi_collector.h"
+#include "vmstat_collector.h"
+#include "process_collector.h"
+#include "socket_collector.h"
+#include "system_stat.h"
+#include "../util/config.h"
+#include "../util/error_handler.h"
+#include "../util/scheduler.h"
+#include "../util/time_util.h"
+#include "../util/triple_buffer.h"
+
+#define MAX_TRIGGER_FDS 8           // Trigger descriptors watched across all collectors
+
+// A scheduled collector filling one section of the snapshot
+typedef struct {
+    sched_task_t task;              // Period, deadline and last run duration
+    bool (*collect)(void*);
+    size_t offset;                  // Section offset in sysmon_snapshot_t
+    size_t size;                    // Section size
+    unsigned int flag;              // SNAPSHOT_* flag of the section
+    bool (*copy)(void*, const void*);   // Deep copy for sections owning heap data
+    void (*release)(void*);             // Frees heap data owned by a section
+    int (*event_fd)(void);          // Descriptor to watch between ticks, or -1
+    bool (*on_event)(void);         // Called when event_fd becomes readable
+    int (*trigger_fds)(struct pollfd*, int);    // Descriptors to watch for POLLPRI
+    bool (*on_trigger)(const struct pollfd*, int);  // True to collect and publish at once
+    const char *config_key;         // Interval key in the configuration file
+    double default_interval;        // Interval in seconds when not configured
+    unsigned long generation;       // Bumped whenever the section is rewritten
+} collector_entry_t;
+
+#define COLLECTOR_ENTRY_EVENTS(fn, field, flg, label, key, interval, copy_fn, release_fn, \
+                               event_fd_fn, on_event_fn) { \
+    .task = { .name = label }, \
+    .collect = (bool(*)(void*))fn, \
+    .offset = offsetof(sysmon_snapshot_t, field), \
+    .size = sizeof(((sysmon_snapshot_t *)0)->field), \
+    .flag = flg, \
+    .copy = (bool(*)(void*, const void*))copy_fn, \
+    .release = (void(*)(void*))release_fn, \
+    .event_fd = event_fd_fn, \
+    .on_event = on_event_fn, \
+    .config_key = key, \
+    .default_interval = interval \
+}
+
+#define COLLECTOR_ENTRY_TRIGGERS(fn, field, flg, label, key, interval, trigger_fds_fn, \
+                                 on_trigger_fn) { \
+    .task = { .name = label }, \
+    .collect = (bool(*)(void*))fn, \
+    .offset = offsetof(sysmon_snapshot_t, field), \
+    .size = sizeof(((sysmon_snapshot_t *)0)->field), \
+    .flag = flg, \
+    .trigger_fds = trigger_fds_fn, \
+    .on_trigger = on_trigger_fn, \
+    .config_key = key, \
+    .default_interval = interval \
+}
+
+#define COLLECTOR_ENTRY_DEEP(fn, field, flg, label, key, interval, copy_fn, release_fn) \
+    COLLECTOR_ENTRY_EVENTS(fn, field, flg, label, key, interval, copy_fn, release_fn, NULL, NULL)
+
+#define COLLECTOR_ENTRY(fn, field, flg, label, key, interval) \
+    COLLECTOR_ENTRY_DEEP(fn, field, flg, label, key, interval, NULL, NULL)
+
+static collector_entry_t collectors[] = {
+    COLLECTOR_ENTRY_DEEP(cpu_collector_collect, cpu, SNAPSHOT_CPU,
+                         "CPU", "interval.cpu", CPU_SAMPLE_INTERVAL,
+                         cpu_metrics_copy, cpu_metrics_free),
+    COLLECTOR_ENTRY(memory_collector_collect, memory, SNAPSHOT_MEMORY,
+                    "Memory", "interval.memory", MEMORY_SAMPLE_INTERVAL),
+    COLLECTOR_ENTRY(vmstat_collector_collect, vmstat, SNAPSHOT_VMSTAT,
+                    "vmstat", "interval.vmstat", VMSTAT_SAMPLE_INTERVAL),
+    COLLECTOR_ENTRY_DEEP(network_collector_collect, network, SNAPSHOT_NETWORK,
+                         "Network", "interval.network", UI_REFRESH_RATE,
+                         network_metrics_copy, network_metrics_free),
+    COLLECTOR_ENTRY_DEEP(disk_collector_collect, disk, SNAPSHOT_DISK,
+                         "Disk", "interval.disk", UI_REFRESH_RATE,
+                         disk_metrics_copy, disk_metrics_free),
+    COLLECTOR_ENTRY_EVENTS(process_collector_collect, processes, SNAPSHOT_PROCESSES,
+                           "Process", "interval.process", PROCESS_SAMPLE_INTERVAL,
+                           process_metrics_copy, process_metrics_free,
+                           process_collector_event_fd, process_collector_handle_events),
+    COLLECTOR_ENTRY(socket_collector_collect, connections, SNAPSHOT_CONNECTIONS,
+                    "Connection", "interval.connections", CONNECTION_SAMPLE_INTERVAL),
+    COLLECTOR_ENTRY_DEEP(filesystem_collector_collect, filesystems, SNAPSHOT_FILESYSTEMS,
+                         "Filesystem", "interval.filesystems", FILESYSTEM_SAMPLE_INTERVAL,
+                         filesystem_metrics_copy, filesystem_metrics_free),
+    COLLECTOR_ENTRY_EVENTS(cgroup_collector_collect, cgroups, SNAPSHOT_CGROUPS,
+                           "cgroup", "interval.cgroups", CGROUP_SAMPLE_INTERVAL,
+                           NULL, NULL, cgroup_collector_event_fd, cgroup_collector_handle_events),
+    COLLECTOR_ENTRY_TRIGGERS(psi_collector_collect, pressure, SNAPSHOT_PRESSURE,
+                             "Pressure", "interval.pressure", PSI_SAMPLE_INTERVAL,
+                             psi_collector_trigger_fds, psi_collector_handle_triggers)
+};
+
+#define NUM_COLLECTORS (sizeof(collectors)/sizeof(collectors[0]))
+
+// Collector thread state
+static struct {
+    pthread_t thread;
+    bool running;
+    int timer_fd;                   // One-shot timer armed for the next deadline
+    int stop_fd;                    // Written by the UI thread to request exit
+    int notify_fd;                  // Written by the collector after each publish
+    scheduler_t sched;
+    triple_buffer_t tb;
+    sysmon_snapshot_t work;         // Collector-owned copy every collector writes to
+    sysmon_snapshot_t slots[3];
+    unsigned long slot_gen[3][NUM_COLLECTORS]; // Section generations held by each slot
+    unsigned long sequence;
+    bool have_snapshot;             // Reader has taken at least one snapshot
+} ct = {
+    .timer_fd = -1,
+    .stop_fd = -1,
+    .notify_fd = -1
+};
+
+// Copy sections that changed since the writer slot was last filled, then publish it
+static void publish_snapshot(void)
+{
+    unsigned int idx = triple_buffer_write_index(&ct.tb);
+    sysmon_snapshot_t *snap = &ct.slots[idx];
+
+    unsigned int failed = 0;
+
+    for (size_t i = 0; i < NUM_COLLECTORS; i++) {
+        if (ct.slot_gen[idx][i] == collectors[i].generation) continue;
+
+        void *dst = (char *)snap + collectors[i].offset;
+        const void *src = (const char *)&ct.work + collectors[i].offset;
+
+        if (collectors[i].copy) {
+            // Slot storage is reused, so this only allocates on a new high
+            if (!collectors[i].copy(dst, src)) {
+                failed |= collectors[i].flag;
+                continue;
+            }
+        } else {
+            memcpy(dst, src, collectors[i].size);
+        }
+        ct.slot_gen[idx][i] = collectors[i].generation;
+    }
+    snap->valid = ct.work.valid & ~failed;
+    snap->sequence = ++ct.sequence;
+
+    triple_buffer_publish(&ct.tb);
+
+    uint64_t one = 1;
+    if (write(ct.notify_fd, &one, sizeof(one)) != sizeof(one)) {
+        log_warning("Failed to signal snapshot publication");
+    }
+}
+
+// Run one collector into the working snapshot and record how long it took
+static void run_collector(collector_entry_t *entry)
+{
+    uint64_t start = monotonic_ns();
+    bool ok = entry->collect((char *)&ct.work + entry->offset);
+    entry->task.last_run_ns = monotonic_ns() - start;
+
+    if (ok) {
+        ct.work.valid |= entry->flag;
+    } else {
+        ct.work.valid &= ~entry->flag;
+        log_error("%s data collection failed", entry->task.name);
+    }
+    entry->generation++;
+
+    if (entry->task.last_run_ns > entry->task.period_ns) {
+        log_warning("%s collection took %.1f ms, longer than its %.1f ms period",
+                    entry->task.name, entry->task.last_run_ns / 1e6,
+                    entry->task.period_ns / 1e6);
+    }
+}
+
+// Run every due collector, publish once, and arm the timer for the next deadline
+static void run_due_collectors(void)
+{
+    uint64_t now = monotonic_ns();
+    bool ran = false;
+    sched_task_t *task;
+
+    // Collectors due together share one /proc/stat read
+    system_stat_invalidate();
+
+    while ((task = scheduler_pop_due(&ct.sched, now)) != NULL) {
+        // task is the first member, so the entry shares its address
+        collector_entry_t *entry = (collector_entry_t *)task;
+        run_collector(entry);
+        ran = true;
+
+        now = monotonic_ns();
+        scheduler_reschedule(&ct.sched, task, now);
+    }
+
+    if (ran) {
+        publish_snapshot();
+    }
+
+    struct itimerspec spec = {
+        .it_value = ns_to_timespec(scheduler_next_deadline(&ct.sched))
+    };
+    if (timerfd_settime(ct.timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1) {
+        log_error("Failed to arm collector timer");
+    }
+}
+
+// Thread body: wait for the next deadline, a collector event, a stall
+// trigger or a stop request
+static void *collector_thread_main(void *arg)
+{
+    (void)arg;
+
+    struct pollfd fds[2 + NUM_COLLECTORS + MAX_TRIGGER_FDS] = {
+        { .fd = ct.timer_fd, .events = POLLIN },
+        { .fd = ct.stop_fd, .events = POLLIN }
+    };
+    collector_entry_t *watched[NUM_COLLECTORS + MAX_TRIGGER_FDS];
+    nfds_t nfds = 2;
+
+    for (size_t i = 0; i < NUM_COLLECTORS; i++) {
+        int fd = collectors[i].event_fd ? collectors[i].event_fd() : -1;
+        if (fd == -1) continue;
+
+        watched[nfds - 2] = &collectors[i];
+        fds[nfds++] = (struct pollfd){ .fd = fd, .events = POLLIN };
+    }
+
+    // Trigger descriptors follow, those of one collector next to each other
+    nfds_t first_trigger = nfds;
+    for (size_t i = 0; i < NUM_COLLECTORS; i++) {
+        if (!collectors[i].trigger_fds) continue;
+
+        int room = (int)(sizeof(fds) / sizeof(fds[0]) - nfds);
+        int n = collectors[i].trigger_fds(&fds[nfds], room);
+        for (int k = 0; k < n; k++) {
+            watched[nfds++ - 2] = &collectors[i];
+        }
+    }
+
+    for (;;) {
+        if (poll(fds, nfds, -1) == -1) {
+            if (errno == EINTR) continue;
+            log_error("Collector thread poll failed");
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) break;
+
+        // Events are folded into collector state; the next tick publishes
+        for (nfds_t i = 2; i < first_trigger; i++) {
+            if (fds[i].revents & POLLIN) {
+                watched[i - 2]->on_event();
+            }
+        }
+
+        // A crossed threshold is collected and published now instead
+        bool due = false;
+        for (nfds_t i = first_trigger; i < nfds; ) {
+            collector_entry_t *entry = watched[i - 2];
+            nfds_t end = i;
+            bool fired = false;
+            while (end < nfds && watched[end - 2] == entry) {
+                fired |= fds[end++].revents != 0;
+            }
+
+            if (fired && entry->on_trigger(&fds[i], (int)(end - i))) {
+                scheduler_expedite(&ct.sched, &entry->task, monotonic_ns());
+                due = true;
+            }
+            for (; i < end; i++) {
+                if (fds[i].revents & (POLLERR | POLLNVAL)) fds[i].fd = -1;
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            uint64_t expirations;
+            if (read(ct.timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                due = true;
+            }
+        }
+        if (due) {
+            run_due_collectors();
+        }
+    }
+    return NULL;
+}
+
+// Close any descriptors that were opened
+static void close_fds(void)
+{
+    if (ct.timer_fd != -1) close(ct.timer_fd);
+    if (ct.stop_fd != -1) close(ct.stop_fd);
+    if (ct.notify_fd != -1) close(ct.notify_fd);
+    ct.timer_fd = ct.stop_fd = ct.notify_fd = -1;
+}
+
+bool collector_thread_start(void)
+{
+    triple_buffer_init(&ct.tb);
+    memset(&ct.work, 0, sizeof(ct.work));
+    memset(ct.slots, 0, sizeof(ct.slots));
+    memset(ct.slot_gen, 0, sizeof(ct.slot_gen));
+    ct.sequence = 0;
+    ct.have_snapshot = false;
+
+    // Every collector runs on its own configurable period
+    uint64_t now = monotonic_ns();
+    scheduler_init(&ct.sched);
+    for (size_t i = 0; i < NUM_COLLECTORS; i++) {
+        double interval = config_get_double(collectors[i].config_key,
+                                            collectors[i].default_interval);
+        if (interval < MIN_SAMPLE_INTERVAL) {
+            log_warning("%s interval %.3fs too short, using %.3fs",
+                        collectors[i].task.name, interval, MIN_SAMPLE_INTERVAL);
+            interval = MIN_SAMPLE_INTERVAL;
+        }
+
+        // Slow collectors still get their first sample within one UI refresh
+        uint64_t period = seconds_to_ns(interval);
+        uint64_t first = period < seconds_to_ns(UI_REFRESH_RATE) ?
+                         period : seconds_to_ns(UI_REFRESH_RATE);
+
+        collectors[i].task.period_ns = period;
+        collectors[i].generation = 1;
+        if (!scheduler_add(&ct.sched, &collectors[i].task, now + first)) {
+            return false;
+        }
+        log_info("%s collector interval: %.3fs", collectors[i].task.name, interval);
+    }
+
+    ct.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    ct.stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ct.notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ct.timer_fd == -1 || ct.stop_fd == -1 || ct.notify_fd == -1) {
+        log_error("Failed to create collector thread descriptors");
+        close_fds();
+        return false;
+    }
+
+    struct itimerspec spec = {
+        .it_value = ns_to_timespec(scheduler_next_deadline(&ct.sched))
+    };
+    if (timerfd_settime(ct.timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1) {
+        log_error("Failed to arm collector timer");
+        close_fds();
+        return false;
+    }
+
+    // The thread inherits the blocked signal mask, so signals keep
+    // going to the UI thread's signalfd
+    int err = pthread_create(&ct.thread, NULL, collector_thread_main, NULL);
+    if (err != 0) {
+        log_error("Failed to create collector thread: %s", strerror(err));
+        close_fds();
+        return false;
+    }
+
+    ct.running = true;
+    return true;
+}
+
+int collector_thread_notify_fd(void)
+{
+    return ct.notify_fd;
+}
+
+void collector_thread_ack(void)
+{
+    uint64_t count;
+    while (read(ct.notify_fd, &count, sizeof(count)) == sizeof(count)) {
+        // Drain
+    }
+}
+
+const sysmon_snapshot_t *collector_thread_acquire(void)
+{
+    if (triple_buffer_update(&ct.tb)) {
+        ct.have_snapshot = true;
+    }
+    return ct.have_snapshot ? &ct.slots[triple_buffer_read_index(&ct.tb)] : NULL;
+}
+
+void collector_thread_stop(void)
+{
+    if (ct.running) {
+        uint64_t one = 1;
+        if (write(ct.stop_fd, &one, sizeof(one)) != sizeof(one)) {
+            log_error("Failed to signal collector thread");
+        }
+        pthread_join(ct.thread, NULL);
+        ct.running = false;
+    }
+    close_fds();
+
+    for (size_t i = 0; i < NUM_COLLECTORS; i++) {
+        if (!collectors[i].release) continue;
+
+        collectors[i].release((char *)&ct.work + collectors[i].offset);
+        for (int slot = 0; slot < 3; slot++) {
+            collectors[i].release((char *)&ct.slots[slot] + collectors[i].offset);
+        }
+    }
+}
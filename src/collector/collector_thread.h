@@ -0,0 +1,28 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * collector_thread.h - Background metric collection and snapshot handoff
+ */
+
+#ifndef COLLECTOR_THREAD_H
+#define COLLECTOR_THREAD_H
+
+#include "../include/sysmon.h"
+
+// Start the collector thread; each collector runs on its configured interval
+bool collector_thread_start(void);
+
+// File descriptor that becomes readable when a new snapshot is published
+int collector_thread_notify_fd(void);
+
+// Clear the readiness of the notify fd
+void collector_thread_ack(void);
+
+// Latest published snapshot, or NULL before the first one.
+// The pointer stays valid until the next call.
+const sysmon_snapshot_t *collector_thread_acquire(void);
+
+// Stop and join the collector thread
+void collector_thread_stop(void);
+
+#endif /* COLLECTOR_THREAD_H */
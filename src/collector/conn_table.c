@@ -0,0 +1,59 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * conn_table.c - Persistent TCP connection table implementation
+ */
+
+#include "conn_table.h"
+
+// Cookies are sequential, so spread them with a 64-bit multiplicative hash
+static uint32_t hash_cookie(uint64_t cookie)
+{
+    return (uint32_t)((cookie * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+static bool cookie_equal(const void *entry, const void *key)
+{
+    return ((const conn_entry_t *)entry)->cookie == *(const uint64_t *)key;
+}
+
+bool conn_table_init(conn_table_t *table, size_t capacity)
+{
+    table->tick = 0;
+    return hash_table_init(&table->table, sizeof(conn_entry_t),
+                           capacity < CONN_TABLE_INITIAL ? CONN_TABLE_INITIAL : capacity);
+}
+
+void conn_table_free(conn_table_t *table)
+{
+    hash_table_free(&table->table);
+}
+
+void conn_table_begin_tick(conn_table_t *table)
+{
+    table->tick++;
+}
+
+conn_entry_t *conn_table_upsert(conn_table_t *table, uint64_t cookie, bool *inserted)
+{
+    conn_entry_t *e = hash_table_upsert(&table->table, hash_cookie(cookie), cookie_equal,
+                                        &cookie, inserted);
+    if (!e) return NULL;
+
+    if (*inserted) e->cookie = cookie;
+    e->seen = table->tick;
+    return e;
+}
+
+void conn_table_end_tick(conn_table_t *table)
+{
+    for (size_t i = 0; i < table->table.capacity; i++) {
+        conn_entry_t *e = hash_table_slot(&table->table, i);
+        if (e->slot.state == HASH_SLOT_LIVE && e->seen != table->tick) {
+            hash_table_remove(&table->table, e);
+        }
+    }
+
+    // Give memory back after a connection storm has drained
+    hash_table_shrink(&table->table, CONN_TABLE_INITIAL);
+}
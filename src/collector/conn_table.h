@@ -0,0 +1,53 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * conn_table.h - Persistent TCP connection table keyed by socket cookie
+ */
+
+#ifndef CONN_TABLE_H
+#define CONN_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/sysmon.h"
+#include "../util/hash_table.h"
+
+#define CONN_TABLE_INITIAL 1024     // Initial and minimum slot count (power of two)
+
+// Per-connection state carried between ticks
+typedef struct {
+    hash_slot_t slot;
+    uint64_t cookie;                // Kernel socket cookie, unique for the socket's lifetime
+    uint64_t bytes_acked;           // Counters at the last sample
+    uint64_t bytes_received;
+    uint32_t total_retrans;
+    uint64_t prev_ns;               // CLOCK_MONOTONIC time of the last sample
+    unsigned long seen;             // Tick in which the socket was last seen
+} conn_entry_t;
+
+// Open sockets by cookie
+typedef struct {
+    hash_table_t table;
+    unsigned long tick;             // Current tick number
+} conn_table_t;
+
+// Allocate a table with at least capacity slots
+bool conn_table_init(conn_table_t *table, size_t capacity);
+
+// Release table storage
+void conn_table_free(conn_table_t *table);
+
+// Start a new tick; entries not seen before the matching end_tick are retired
+void conn_table_begin_tick(conn_table_t *table);
+
+// Find or insert the entry for cookie and mark it seen this tick.
+// *inserted is set for a new socket. The pointer is valid until the
+// next upsert.
+conn_entry_t *conn_table_upsert(conn_table_t *table, uint64_t cookie, bool *inserted);
+
+// Tombstone sockets that were not seen this tick, shrinking the table
+// after a large drop in connection count
+void conn_table_end_tick(conn_table_t *table);
+
+#endif /* CONN_TABLE_H */
@@ -0,0 +1,321 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * cpu_burst.c - High-frequency per-core busy sampler
+ * 
+ * At the CPU collector's interval a core that is saturated for 50 ms
+ * shows up as a few percent. A helper thread therefore re-reads
+ * /proc/stat every cpu.burst_ms milliseconds through its own descriptor
+ * and stores each core's busy fraction since its previous read in a ring
+ * of fixed-size rows. The collector drains the ring once per tick and
+ * reduces the rows to a per-core max and 99th percentile.
+ * 
+ * The sampler is the only writer and the collector thread the only
+ * reader, so the ring needs no lock: every row carries the number of the
+ * sample it holds, cleared while the row is rewritten, and a reader that
+ * sees the number change under it drops the row.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cpu_burst.h"
+#include "../util/config.h"
+#include "../util/error_handler.h"
+#include "../util/procfs_parse.h"
+#include "../util/time_util.h"
+
+#define PROC_STAT_PATH "/proc/stat"
+#define BURST_BUFFER_INITIAL 8192
+#define BURST_SLOTS 256                 // Ring rows, a power of two
+#define BURST_MIN_MS 10                 // /proc/stat counts in 10 ms ticks (USER_HZ)
+#define BURST_MAX_MS 50
+#define BURST_OVERHEAD_LIMIT 0.005      // Share of one core the sampler may use
+#define BURST_OVERHEAD_WINDOW_NS (5 * NSEC_PER_SEC) // Period the share is measured over
+#define BURST_NO_SAMPLE -1.0f           // Core had no line, or no tick passed
+
+static struct {
+    bool running;
+    pthread_t thread;
+    atomic_bool stop;
+    int ncpus;                          // Entries per row: CPU ids 0..ncpus-1
+    uint64_t started_ns;
+
+    // Ring, written by the sampler only
+    float *busy;                        // BURST_SLOTS rows of ncpus busy fractions
+    atomic_uint_fast64_t *seq;          // Per row: sample number + 1, or 0 while rewritten
+    atomic_uint_fast64_t head;          // Samples written so far
+
+    // Sampler state
+    procfs_file_t file;
+    procfs_buf_t buf;
+    uint64_t *prev_total;               // Per CPU id, ticks at the last read
+    uint64_t *prev_idle;
+    float *row;                         // Sample being parsed
+    uint64_t interval_ns;
+    uint64_t cpu_ns;                    // Thread CPU time when it stopped
+
+    // Reader state, collector thread only
+    uint64_t tail;                      // Next sample to read
+    float *rows;                        // Samples copied out of the ring
+    float *column;                      // One core's samples, reordered by select
+} burst = { .file = { .fd = -1 } };
+
+static uint64_t thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+// Read /proc/stat into burst.row: each core's busy fraction since the
+// previous read, BURST_NO_SAMPLE where there is none
+static bool take_sample(void)
+{
+    for (int i = 0; i < burst.ncpus; i++) burst.row[i] = BURST_NO_SAMPLE;
+
+    if (!procfs_file_read(&burst.file, &burst.buf)) return false;
+
+    procfs_cursor_t cur = procfs_cursor(&burst.buf);
+    procfs_cursor_t line;
+    uint64_t id, value;
+
+    while (procfs_next_line(&cur, &line)) {
+        // The cpu lines come first; stop before the long intr line
+        if (!procfs_consume(&line, "cpu", 3)) break;
+        if (line.p == line.end || *line.p == ' ') continue;     // Aggregate line
+        if (!procfs_parse_u64(&line, &id) || id >= (uint64_t)burst.ncpus) continue;
+
+        // user nice system idle iowait irq softirq steal, as cpu_times_total()
+        uint64_t total = 0, idle = 0;
+        for (int f = 0; f < 8 && procfs_parse_u64(&line, &value); f++) {
+            total += value;
+            if (f == 3) idle = value;
+        }
+
+        uint64_t diff_total = total - burst.prev_total[id];
+        uint64_t diff_idle = idle - burst.prev_idle[id];
+        if (burst.prev_total[id] > 0 && total > burst.prev_total[id] &&
+            idle >= burst.prev_idle[id] && diff_idle <= diff_total) {
+            burst.row[id] = (float)(diff_total - diff_idle) / (float)diff_total;
+        }
+        burst.prev_total[id] = total;
+        burst.prev_idle[id] = idle;
+    }
+    return true;
+}
+
+// Copy burst.row into the next ring row and publish it
+static void publish_sample(void)
+{
+    uint64_t n = atomic_load_explicit(&burst.head, memory_order_relaxed);
+    size_t slot = n & (BURST_SLOTS - 1);
+
+    atomic_store_explicit(&burst.seq[slot], 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&burst.busy[slot * burst.ncpus], burst.row, burst.ncpus * sizeof(float));
+    atomic_store_explicit(&burst.seq[slot], n + 1, memory_order_release);
+    atomic_store_explicit(&burst.head, n + 1, memory_order_release);
+}
+
+static void *sampler_main(void *arg)
+{
+    (void)arg;
+    uint64_t next = monotonic_ns();
+    uint64_t window_start = next;
+    uint64_t window_cpu = thread_cpu_ns();
+
+    while (!atomic_load_explicit(&burst.stop, memory_order_relaxed)) {
+        if (take_sample()) publish_sample();
+
+        // Sample less often if reading /proc/stat costs more than allowed,
+        // e.g. on a machine with many cores
+        uint64_t now = monotonic_ns();
+        if (now - window_start >= BURST_OVERHEAD_WINDOW_NS) {
+            uint64_t cpu = thread_cpu_ns();
+            double share = (double)(cpu - window_cpu) / (double)(now - window_start);
+            if (share > BURST_OVERHEAD_LIMIT && burst.interval_ns < BURST_MAX_MS * 1000000ULL) {
+                burst.interval_ns *= 2;
+                if (burst.interval_ns > BURST_MAX_MS * 1000000ULL) {
+                    burst.interval_ns = BURST_MAX_MS * 1000000ULL;
+                }
+                log_warning("CPU burst sampler used %.2f%% of a core, sampling every %llu ms",
+                            share * 100.0, (unsigned long long)(burst.interval_ns / 1000000));
+            }
+            window_start = now;
+            window_cpu = cpu;
+        }
+
+        // After a stall, continue from now rather than catching up
+        next += burst.interval_ns;
+        if (next < now) next = now;
+        struct timespec ts = ns_to_timespec(next);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+
+    burst.cpu_ns = thread_cpu_ns();
+    return NULL;
+}
+
+bool cpu_burst_init(void)
+{
+    long ms = config_get_long("cpu.burst_ms", 0);
+    if (ms <= 0) return true;
+    if (ms < BURST_MIN_MS || ms > BURST_MAX_MS) {
+        long clamped = ms < BURST_MIN_MS ? BURST_MIN_MS : BURST_MAX_MS;
+        log_warning("cpu.burst_ms must be between %d and %d, using %ld",
+                    BURST_MIN_MS, BURST_MAX_MS, clamped);
+        ms = clamped;
+    }
+
+    long ncpus = sysconf(_SC_NPROCESSORS_CONF);
+    burst.ncpus = ncpus > 0 ? (int)ncpus : 1;
+    burst.interval_ns = (uint64_t)ms * 1000000ULL;
+
+    size_t ring = (size_t)BURST_SLOTS * burst.ncpus;
+    burst.busy = calloc(ring, sizeof(float));
+    burst.rows = calloc(ring, sizeof(float));
+    burst.column = calloc(BURST_SLOTS, sizeof(float));
+    burst.row = calloc(burst.ncpus, sizeof(float));
+    burst.seq = calloc(BURST_SLOTS, sizeof(*burst.seq));
+    burst.prev_total = calloc(burst.ncpus, sizeof(uint64_t));
+    burst.prev_idle = calloc(burst.ncpus, sizeof(uint64_t));
+    if (!burst.busy || !burst.rows || !burst.column || !burst.row || !burst.seq ||
+        !burst.prev_total || !burst.prev_idle ||
+        !procfs_buf_init(&burst.buf, BURST_BUFFER_INITIAL)) {
+        log_error("Memory allocation failed");
+        cpu_burst_cleanup();
+        return false;
+    }
+    if (!procfs_file_open(&burst.file, PROC_STAT_PATH)) {
+        log_error("Failed to open %s", PROC_STAT_PATH);
+        cpu_burst_cleanup();
+        return false;
+    }
+
+    // First read only sets the previous counters
+    take_sample();
+
+    atomic_init(&burst.head, 0);
+    atomic_init(&burst.stop, false);
+    burst.tail = 0;
+
+    // Signals go to the main thread, as for the collector thread
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    int err = pthread_create(&burst.thread, NULL, sampler_main, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (err != 0) {
+        log_error("Failed to create CPU burst sampler thread: %s", strerror(err));
+        cpu_burst_cleanup();
+        return false;
+    }
+
+    burst.running = true;
+    burst.started_ns = monotonic_ns();
+    log_info("CPU burst sampler: every %ld ms", ms);
+    return true;
+}
+
+// Move the k-th smallest of values[0..n) to index k (Hoare's selection)
+static float select_kth(float *values, int n, int k)
+{
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        float pivot = values[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (values[i] < pivot) i++;
+            while (values[j] > pivot) j--;
+            if (i <= j) {
+                float t = values[i];
+                values[i++] = values[j];
+                values[j--] = t;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+    return values[k];
+}
+
+int cpu_burst_drain(const int *ids, int count, double *max, double *p99)
+{
+    if (!burst.running) return 0;
+
+    uint64_t head = atomic_load_explicit(&burst.head, memory_order_acquire);
+    uint64_t first = burst.tail;
+
+    // The sampler may already be rewriting the oldest row
+    if (head - first > BURST_SLOTS - 1) first = head - (BURST_SLOTS - 1);
+    burst.tail = head;
+
+    int n = 0;
+    for (uint64_t s = first; s < head; s++) {
+        size_t slot = s & (BURST_SLOTS - 1);
+        uint64_t seq = atomic_load_explicit(&burst.seq[slot], memory_order_acquire);
+        if (seq != s + 1) continue;
+
+        memcpy(&burst.rows[(size_t)n * burst.ncpus], &burst.busy[slot * burst.ncpus],
+               burst.ncpus * sizeof(float));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&burst.seq[slot], memory_order_relaxed) != seq) continue;
+        n++;
+    }
+    if (n == 0) return 0;
+
+    for (int c = 0; c < count; c++) {
+        int id = ids[c];
+        int k = 0;
+        float peak = 0.0f;
+        for (int r = 0; id >= 0 && id < burst.ncpus && r < n; r++) {
+            float v = burst.rows[(size_t)r * burst.ncpus + id];
+            if (v < 0.0f) continue;
+            burst.column[k++] = v;
+            if (v > peak) peak = v;
+        }
+
+        // Nearest-rank percentile: rank ceil(0.99 * k), which is the max
+        // only below 100 samples (at 100 it is the second highest)
+        max[c] = 100.0 * peak;
+        p99[c] = k > 0 ? 100.0 * select_kth(burst.column, k, (99 * k + 99) / 100 - 1) : 0.0;
+    }
+    return n;
+}
+
+void cpu_burst_cleanup(void)
+{
+    if (burst.running) {
+        atomic_store_explicit(&burst.stop, true, memory_order_relaxed);
+        pthread_join(burst.thread, NULL);
+        burst.running = false;
+
+        uint64_t elapsed = monotonic_ns() - burst.started_ns;
+        uint64_t samples = atomic_load_explicit(&burst.head, memory_order_relaxed);
+        log_info("CPU burst sampler: %llu samples, %.3f%% of a core",
+                 (unsigned long long)samples,
+                 elapsed > 0 ? 100.0 * burst.cpu_ns / elapsed : 0.0);
+    }
+
+    procfs_file_close(&burst.file);
+    procfs_buf_free(&burst.buf);
+    free(burst.busy);
+    free(burst.rows);
+    free(burst.column);
+    free(burst.row);
+    free(burst.seq);
+    free(burst.prev_total);
+    free(burst.prev_idle);
+    burst.busy = burst.rows = burst.column = burst.row = NULL;
+    burst.seq = NULL;
+    burst.prev_total = burst.prev_idle = NULL;
+}
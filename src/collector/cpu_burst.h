@@ -0,0 +1,24 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * cpu_burst.h - High-frequency per-core busy sampler
+ */
+
+#ifndef CPU_BURST_H
+#define CPU_BURST_H
+
+#include "../include/sysmon.h"
+
+// Start the sampler thread if cpu.burst_ms is set. Without it, or if the
+// thread cannot start, the CPU collector reports no burst figures.
+bool cpu_burst_init(void);
+
+// Summarize the samples taken since the last call: for each of the count
+// cores in ids, the highest and the 99th percentile busy percentage.
+// Returns the number of samples, 0 if the sampler is off or has none yet.
+int cpu_burst_drain(const int *ids, int count, double *max, double *p99);
+
+// Stop the sampler thread and release its buffers
+void cpu_burst_cleanup(void);
+
+#endif /* CPU_BURST_H */
@@ -4,136 +4,330 @@
  * cpu_collector.c - CPU statistics collector implementation
  */
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <ctype.h>
 
 #include "cpu_collector.h"
+#include "cpu_burst.h"
+#include "system_stat.h"
 #include "../util/error_handler.h"
 
-// File containing CPU statistics
-#define PROC_STAT_PATH "/proc/stat"
+#define CPU_METRICS_INITIAL 64      // Initial per-core capacity, a multiple of CPU_LANES
 
-// Previous CPU time measurements
+// Previous per-core counters, entry for entry aligned with the current
+// /proc/stat read; spare_cores is scratch for realigning after hotplug
+static cpu_core_counters_t prev_cores;
+static cpu_core_counters_t spare_cores;
+
+// Previous aggregate "cpu" line
+static cpu_times_t prev_total;
+
+// Previous system-wide counters for rate calculation
 static struct {
-    unsigned long user[MAX_CPU_CORES + 1];   // +1 for total CPU
-    unsigned long nice[MAX_CPU_CORES + 1];
-    unsigned long system[MAX_CPU_CORES + 1];
-    unsigned long idle[MAX_CPU_CORES + 1];
-    unsigned long iowait[MAX_CPU_CORES + 1];
-    unsigned long irq[MAX_CPU_CORES + 1];
-    unsigned long softirq[MAX_CPU_CORES + 1];
-    unsigned long steal[MAX_CPU_CORES + 1];
-} prev_times;
-
-static int num_cores = 0;
+    unsigned long long ctxt;
+    unsigned long long intr;
+    uint64_t timestamp_ns;
+} prev_counters;
 
-bool cpu_collector_init(void) {
-    FILE *file = fopen(PROC_STAT_PATH, "r");
-    if (file == NULL) {
-        log_error("Failed to open %s", PROC_STAT_PATH);
+// Resize one per-core array, leaving it untouched on failure
+static bool grow_array(void **array, int capacity, size_t size) {
+    void *grown = realloc(*array, capacity * size);
+    if (!grown) {
+        log_error("Memory allocation failed");
         return false;
     }
+    *array = grown;
+    return true;
+}
 
-    // Count the number of CPU cores
-    char line[256];
-    num_cores = 0;
-    
-    while (fgets(line, sizeof(line), file)) {
-        if (strncmp(line, "cpu", 3) == 0 && isdigit(line[3])) {
-            num_cores++;
+bool cpu_metrics_reserve(cpu_metrics_t *metrics, int n) {
+    if (n <= metrics->capacity) return true;
+
+    int capacity = metrics->capacity > 0 ? metrics->capacity : CPU_METRICS_INITIAL;
+    while (capacity < n) capacity *= 2;
+
+    if (!grow_array((void **)&metrics->core_ids, capacity, sizeof(int)) ||
+        !grow_array((void **)&metrics->core_usage, capacity, sizeof(double)) ||
+        !grow_array((void **)&metrics->core_burst_max, capacity, sizeof(double)) ||
+        !grow_array((void **)&metrics->core_burst_p99, capacity, sizeof(double))) {
+        return false;
+    }
+    for (int s = 0; s < CPU_STATE_COUNT; s++) {
+        if (!grow_array((void **)&metrics->core_state[s], capacity, sizeof(double))) return false;
+    }
+    metrics->capacity = capacity;
+    return true;
+}
+
+bool cpu_metrics_copy(cpu_metrics_t *dst, const cpu_metrics_t *src) {
+    if (!cpu_metrics_reserve(dst, src->num_cores)) return false;
+
+    // Summary fields first, keeping dst's own arrays
+    cpu_metrics_t arrays = *dst;
+    *dst = *src;
+    dst->core_ids = arrays.core_ids;
+    dst->core_usage = arrays.core_usage;
+    memcpy(dst->core_state, arrays.core_state, sizeof(dst->core_state));
+    dst->core_burst_max = arrays.core_burst_max;
+    dst->core_burst_p99 = arrays.core_burst_p99;
+    dst->capacity = arrays.capacity;
+
+    if (src->num_cores > 0) {
+        memcpy(dst->core_ids, src->core_ids, src->num_cores * sizeof(int));
+        memcpy(dst->core_usage, src->core_usage, src->num_cores * sizeof(double));
+        for (int s = 0; s < CPU_STATE_COUNT; s++) {
+            memcpy(dst->core_state[s], src->core_state[s], src->num_cores * sizeof(double));
+        }
+        if (src->burst_samples > 0) {
+            memcpy(dst->core_burst_max, src->core_burst_max, src->num_cores * sizeof(double));
+            memcpy(dst->core_burst_p99, src->core_burst_p99, src->num_cores * sizeof(double));
         }
     }
-    
-    fclose(file);
+    return true;
+}
 
-    if (num_cores == 0) {
-        log_error("No CPU cores detected");
+void cpu_metrics_free(cpu_metrics_t *metrics) {
+    free(metrics->core_ids);
+    free(metrics->core_usage);
+    free(metrics->core_burst_max);
+    free(metrics->core_burst_p99);
+    metrics->core_ids = NULL;
+    metrics->core_usage = NULL;
+    metrics->core_burst_max = NULL;
+    metrics->core_burst_p99 = NULL;
+    for (int s = 0; s < CPU_STATE_COUNT; s++) {
+        free(metrics->core_state[s]);
+        metrics->core_state[s] = NULL;
+    }
+    metrics->num_cores = 0;
+    metrics->capacity = 0;
+}
+
+bool cpu_collector_init(void) {
+    const system_stat_t *stat = system_stat_get();
+    if (stat == NULL) {
+        log_error("Failed to read CPU statistics");
         return false;
     }
 
-    if (num_cores > MAX_CPU_CORES) {
-        log_warning("Truncating detected cores from %d to %d", num_cores, MAX_CPU_CORES);
-        num_cores = MAX_CPU_CORES;
+    if (stat->cores.count == 0) {
+        log_error("No CPU cores detected");
+        return false;
     }
 
+    memset(&prev_total, 0, sizeof(prev_total));
+    memset(&prev_counters, 0, sizeof(prev_counters));
+    prev_cores.count = 0;
+
     // Initialize with first reading
-    return cpu_collector_collect(NULL);
+    if (!cpu_collector_collect(NULL)) return false;
+
+    // Optional; the collector works without it
+    cpu_burst_init();
+    return true;
+}
+
+// a - b for counters that may step backwards, clamped at zero
+static unsigned long long saturating_sub(unsigned long long a, unsigned long long b) {
+    return a > b ? a - b : 0;
 }
 
-bool cpu_collector_collect(cpu_data *data) {
+// Usage and per-state shares of all CPUs between two readings of the
+// aggregate line; both are left as they were if no time passed
+static void compute_total(const cpu_times_t *cur, const cpu_times_t *prev, cpu_metrics_t *data) {
+    unsigned long long total = cpu_times_total(cur);
+    unsigned long long prev_total = cpu_times_total(prev);
+
+    if (prev_total == 0 || total <= prev_total) return;
+
+    unsigned long long diff_total = total - prev_total;
+    unsigned long long diff_idle = saturating_sub(cur->idle, prev->idle);
+    unsigned long long guest = saturating_sub(cur->guest, prev->guest);
+    unsigned long long guest_nice = saturating_sub(cur->guest_nice, prev->guest_nice);
+    double scale = 100.0 / diff_total;
+    double *state = data->total_state;
+
+    data->total_usage = saturating_sub(diff_total, diff_idle) * scale;
+    state[CPU_STATE_USER] = saturating_sub(saturating_sub(cur->user, prev->user), guest) * scale;
+    state[CPU_STATE_NICE] = saturating_sub(saturating_sub(cur->nice, prev->nice), guest_nice) * scale;
+    state[CPU_STATE_SYSTEM] = saturating_sub(cur->system, prev->system) * scale;
+    state[CPU_STATE_IOWAIT] = saturating_sub(cur->iowait, prev->iowait) * scale;
+    state[CPU_STATE_IRQ] = saturating_sub(cur->irq, prev->irq) * scale;
+    state[CPU_STATE_SOFTIRQ] = saturating_sub(cur->softirq, prev->softirq) * scale;
+    state[CPU_STATE_STEAL] = saturating_sub(cur->steal, prev->steal) * scale;
+    state[CPU_STATE_GUEST] = (guest + guest_nice) * scale;
+}
+
+// True if the current read lists the same CPUs as the previous one
+static bool same_cores(const cpu_core_counters_t *cur) {
+    return cur->count == prev_cores.count &&
+           memcmp(cur->ids, prev_cores.ids, cur->count * sizeof(int)) == 0;
+}
+
+// CPUs went on- or offline: move each previous sample to the entry of
+// its id in the current read. CPUs that just came online take their
+// current counters and so report no usage until their next sample.
+static bool realign_prev(const cpu_core_counters_t *cur) {
+    if (!cpu_core_counters_reserve(&spare_cores, cur->count)) return false;
+
+    double *from[CPU_CORE_FIELDS], *now[CPU_CORE_FIELDS], *to[CPU_CORE_FIELDS];
+    cpu_core_counters_arrays(&prev_cores, from);
+    cpu_core_counters_arrays(cur, now);
+    cpu_core_counters_arrays(&spare_cores, to);
+
+    // Both id lists ascend, so one merge pass finds every match
+    int j = 0;
+    for (int i = 0; i < cur->count; i++) {
+        while (j < prev_cores.count && prev_cores.ids[j] < cur->ids[i]) j++;
+        bool kept = j < prev_cores.count && prev_cores.ids[j] == cur->ids[i];
+
+        spare_cores.ids[i] = cur->ids[i];
+        for (int f = 0; f < CPU_CORE_FIELDS; f++) {
+            to[f][i] = kept ? from[f][j] : now[f][i];
+        }
+    }
+    spare_cores.count = cur->count;
+
+    if (prev_cores.count > 0) log_info("Online CPUs changed: %d -> %d", prev_cores.count, cur->count);
+
+    cpu_core_counters_t swap = prev_cores;
+    prev_cores = spare_cores;
+    spare_cores = swap;
+    return true;
+}
+
+// max(x, 0) without a branch, so loops using it stay vectorizable
+static inline double non_negative(double x) {
+    return (x + fabs(x)) * 0.5;
+}
+
+/*
+ * Usage and per-state shares of every core in one pass over the counter
+ * arrays, written straight into the snapshot's preallocated arrays. Each
+ * output is its own restrict parameter so the compiler knows they do not
+ * overlap and needs no runtime alias checks. The
+ * body handles CPU_LANES cores at a time, loads every counter once and
+ * has no branches: comparisons are turned into 0.0/1.0 factors, which
+ * lets the compiler emit SIMD code for it. Padding entries past count
+ * produce values nobody reads. Counters that step backwards count as
+ * unchanged, and a core whose counters did not move reports zero.
+ */
+static void compute_cores(const cpu_core_counters_t *cur, const cpu_core_counters_t *prev,
+                          double *restrict usage, double *restrict s_user,
+                          double *restrict s_nice, double *restrict s_system,
+                          double *restrict s_iowait, double *restrict s_irq,
+                          double *restrict s_softirq, double *restrict s_steal,
+                          double *restrict s_guest) {
+    const double *restrict user = cur->user, *restrict nice = cur->nice;
+    const double *restrict system = cur->system, *restrict idle = cur->idle;
+    const double *restrict iowait = cur->iowait, *restrict irq = cur->irq;
+    const double *restrict softirq = cur->softirq, *restrict steal = cur->steal;
+    const double *restrict guest = cur->guest, *restrict guest_nice = cur->guest_nice;
+    const double *restrict p_user = prev->user, *restrict p_nice = prev->nice;
+    const double *restrict p_system = prev->system, *restrict p_idle = prev->idle;
+    const double *restrict p_iowait = prev->iowait, *restrict p_irq = prev->irq;
+    const double *restrict p_softirq = prev->softirq, *restrict p_steal = prev->steal;
+    const double *restrict p_guest = prev->guest, *restrict p_guest_nice = prev->guest_nice;
+    int padded = cpu_core_counters_padded(cur);
+
+    for (int base = 0; base < padded; base += CPU_LANES) {
+        for (int k = 0; k < CPU_LANES; k++) {
+            int i = base + k;
+            double d_user = user[i] - p_user[i];
+            double d_nice = nice[i] - p_nice[i];
+            double d_system = non_negative(system[i] - p_system[i]);
+            double d_idle = non_negative(idle[i] - p_idle[i]);
+            double d_iowait = non_negative(iowait[i] - p_iowait[i]);
+            double d_irq = non_negative(irq[i] - p_irq[i]);
+            double d_softirq = non_negative(softirq[i] - p_softirq[i]);
+            double d_steal = non_negative(steal[i] - p_steal[i]);
+            double d_guest = non_negative(guest[i] - p_guest[i]);
+            double d_guest_nice = non_negative(guest_nice[i] - p_guest_nice[i]);
+
+            double diff_total = non_negative(d_user) + non_negative(d_nice) + d_system + d_idle +
+                                d_iowait + d_irq + d_softirq + d_steal;
+            double moved = diff_total > 0.0;
+            double scale = moved * 100.0 / (diff_total + (1.0 - moved));
+
+            usage[i] = scale * (diff_total - d_idle);
+            // Guest time is part of user and nice; report it apart
+            s_user[i] = scale * non_negative(d_user - d_guest);
+            s_nice[i] = scale * non_negative(d_nice - d_guest_nice);
+            s_system[i] = scale * d_system;
+            s_iowait[i] = scale * d_iowait;
+            s_irq[i] = scale * d_irq;
+            s_softirq[i] = scale * d_softirq;
+            s_steal[i] = scale * d_steal;
+            s_guest[i] = scale * (d_guest + d_guest_nice);
+        }
+    }
+}
+
+// Remember the current per-core counters for the next tick
+static void save_prev(const cpu_core_counters_t *cur) {
+    double *from[CPU_CORE_FIELDS], *to[CPU_CORE_FIELDS];
+    cpu_core_counters_arrays(cur, from);
+    cpu_core_counters_arrays(&prev_cores, to);
+
+    for (int f = 0; f < CPU_CORE_FIELDS; f++) {
+        memcpy(to[f], from[f], cur->count * sizeof(double));
+    }
+}
+
+bool cpu_collector_collect(cpu_metrics_t *data) {
     if (data == NULL) {
         // Initialization call - just populate previous values
-        cpu_data dummy;
-        return cpu_collector_collect(&dummy);
+        cpu_metrics_t scratch = { 0 };
+        bool ok = cpu_collector_collect(&scratch);
+        cpu_metrics_free(&scratch);
+        return ok;
     }
 
-    FILE *file = fopen(PROC_STAT_PATH, "r");
-    if (file == NULL) {
-        log_error("Failed to open %s", PROC_STAT_PATH);
+    const system_stat_t *stat = system_stat_get();
+    if (stat == NULL) {
         return false;
     }
 
-    char line[256];
-    int core_index = -1;  // -1 for total CPU, 0+ for cores
-    data->num_cores = num_cores;
+    const cpu_core_counters_t *cores = &stat->cores;
+    if (!same_cores(cores) && !realign_prev(cores)) return false;
+    if (!cpu_metrics_reserve(data, cpu_core_counters_padded(cores))) return false;
 
-    while (fgets(line, sizeof(line), file) && core_index < num_cores) {
-        if (strncmp(line, "cpu", 3) != 0) continue;
+    compute_total(&stat->total, &prev_total, data);
+    prev_total = stat->total;
 
-        // Determine if this is total CPU or specific core
-        if (isdigit(line[3])) {
-            core_index = atoi(line + 3);
-            if (core_index >= num_cores) continue;
-        } else {
-            core_index = -1;  // Total CPU
-        }
-
-        // Parse CPU time values
-        unsigned long user, nice, system, idle, iowait, irq, softirq, steal;
-        if (sscanf(line + 5, "%lu %lu %lu %lu %lu %lu %lu %lu",
-                  &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal) < 4) {
-            continue;
-        }
+    data->num_cores = cores->count;
+    memcpy(data->core_ids, cores->ids, cores->count * sizeof(int));
+    double *const *state = data->core_state;
+    compute_cores(cores, &prev_cores, data->core_usage,
+                  state[CPU_STATE_USER], state[CPU_STATE_NICE], state[CPU_STATE_SYSTEM],
+                  state[CPU_STATE_IOWAIT], state[CPU_STATE_IRQ], state[CPU_STATE_SOFTIRQ],
+                  state[CPU_STATE_STEAL], state[CPU_STATE_GUEST]);
+    save_prev(cores);
 
-        // Calculate usage percentages
-        int store_index = core_index + 1;  // +1 because total CPU is at 0
-        unsigned long total = user + nice + system + idle + iowait + irq + softirq + steal;
-        unsigned long prev_total = prev_times.user[store_index] + prev_times.nice[store_index] +
-                                 prev_times.system[store_index] + prev_times.idle[store_index] +
-                                 prev_times.iowait[store_index] + prev_times.irq[store_index] +
-                                 prev_times.softirq[store_index] + prev_times.steal[store_index];
-
-        if (prev_total > 0 && total > prev_total) {
-            unsigned long diff_total = total - prev_total;
-            unsigned long diff_used = diff_total - (idle - prev_times.idle[store_index]);
-
-            double usage = 100.0 * diff_used / diff_total;
-
-            if (core_index == -1) {
-                data->total_usage = usage;
-            } else {
-                data->core_usage[core_index] = usage;
-            }
-        }
+    // Peaks the regular samples average away
+    data->burst_samples = cpu_burst_drain(data->core_ids, data->num_cores,
+                                          data->core_burst_max, data->core_burst_p99);
 
-        // Store current values for next reading
-        prev_times.user[store_index] = user;
-        prev_times.nice[store_index] = nice;
-        prev_times.system[store_index] = system;
-        prev_times.idle[store_index] = idle;
-        prev_times.iowait[store_index] = iowait;
-        prev_times.irq[store_index] = irq;
-        prev_times.softirq[store_index] = softirq;
-        prev_times.steal[store_index] = steal;
+    // System-wide scheduler activity
+    data->procs_running = stat->procs_running;
+    data->procs_blocked = stat->procs_blocked;
+    if (prev_counters.timestamp_ns > 0 && stat->timestamp_ns > prev_counters.timestamp_ns) {
+        double elapsed = (stat->timestamp_ns - prev_counters.timestamp_ns) / 1e9;
+        data->ctxt_rate = (stat->ctxt - prev_counters.ctxt) / elapsed;
+        data->intr_rate = (stat->intr - prev_counters.intr) / elapsed;
     }
+    prev_counters.ctxt = stat->ctxt;
+    prev_counters.intr = stat->intr;
+    prev_counters.timestamp_ns = stat->timestamp_ns;
 
-    fclose(file);
     return true;
 }
 
 void cpu_collector_cleanup(void) {
-    // No dynamic resources to clean up
+    cpu_burst_cleanup();
+    cpu_core_counters_free(&prev_cores);
+    cpu_core_counters_free(&spare_cores);
 }
@@ -9,21 +9,20 @@
 
 #include "../include/sysmon.h"
 
-// Maximum number of CPU cores we support tracking
-#define MAX_CPU_CORES 64
-
-// Structure to hold CPU usage data
-typedef struct {
-    double total_usage;          // Total CPU usage percentage
-    double core_usage[MAX_CPU_CORES]; // Per-core usage percentages
-    int num_cores;               // Number of CPU cores detected
-} cpu_data;
-
 // Initialize the CPU collector
 bool cpu_collector_init(void);
 
 // Collect CPU data
-bool cpu_collector_collect(cpu_data *data);
+bool cpu_collector_collect(cpu_metrics_t *data);
+
+// Make room for at least n cores in the per-core arrays
+bool cpu_metrics_reserve(cpu_metrics_t *metrics, int n);
+
+// Deep-copy metrics, growing dst's arrays as needed
+bool cpu_metrics_copy(cpu_metrics_t *dst, const cpu_metrics_t *src);
+
+// Release the per-core arrays
+void cpu_metrics_free(cpu_metrics_t *metrics);
 
 // Clean up CPU collector resources
 void cpu_collector_cleanup(void);
@@ -8,96 +8,259 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <time.h>
 
 #include "disk_collector.h"
+#include "disk_index.h"
+#include "../util/config.h"
 #include "../util/error_handler.h"
 #include "../util/logger.h"
+#include "../util/procfs_parse.h"
+#include "../util/time_util.h"
 
 #define PROC_DISKSTATS "/proc/diskstats"
- 
-// Static variables for rate calculations
-static struct {
-    unsigned long prev_read;
-    unsigned long prev_write;
-    time_t prev_time;
-} disk_state;
- 
-// Initialize disk collector
-bool disk_collector_init(void)
+#define SECTOR_SIZE 512             // /proc/diskstats always counts 512-byte sectors
+#define DISK_METRICS_INITIAL 8      // Initial device array capacity
+
+// Every block device, rebuilt when the set in /proc/diskstats changes
+static disk_index_t devices;
+
+// Which devices are reported individually
+static bool show_partitions = false;
+static bool show_virtual = false;
+
+// /proc/diskstats kept open and re-read with pread each tick
+static procfs_file_t diskstats_file = { .fd = -1 };
+static procfs_buf_t diskstats_buf;
+
+// Parse "major minor name" at the start of a line
+static bool parse_device_id(procfs_cursor_t *line, unsigned int *major, unsigned int *minor,
+                            const char **name, size_t *len)
 {
-    memset(&disk_state, 0, sizeof(disk_state));
-    disk_state.prev_time = time(NULL);
+    uint64_t maj, min;
+    if (!procfs_parse_u64(line, &maj) || !procfs_parse_u64(line, &min) ||
+        !procfs_next_token(line, name, len)) {
+        return false;
+    }
+    *major = (unsigned int)maj;
+    *minor = (unsigned int)min;
     return true;
 }
- 
-// Read global disk stats from /proc/diskstats
-static bool read_global_disk_stats(disk_metrics_t *metrics)
+
+// Parse the counters that follow the device name
+static bool parse_counters(procfs_cursor_t *line, disk_counters_t *c)
 {
-    FILE *fp = fopen(PROC_DISKSTATS, "r");
-    if (!fp) {
-        log_error("Failed to open %S", PROC_DISKSTATS);
-        return false;
+    // reads merged sectors ms, writes merged sectors ms, in_flight io_ticks ...
+    return procfs_parse_u64(line, &c->reads) &&
+           procfs_skip_fields(line, 1) &&
+           procfs_parse_u64(line, &c->sectors_read) &&
+           procfs_parse_u64(line, &c->read_ms) &&
+           procfs_parse_u64(line, &c->writes) &&
+           procfs_skip_fields(line, 1) &&
+           procfs_parse_u64(line, &c->sectors_written) &&
+           procfs_parse_u64(line, &c->write_ms) &&
+           procfs_skip_fields(line, 1) &&
+           procfs_parse_u64(line, &c->io_ticks);
+}
+
+// Fingerprint of the devices listed in the current buffer
+static uint64_t diskstats_fingerprint(void)
+{
+    procfs_cursor_t cur = procfs_cursor(&diskstats_buf);
+    procfs_cursor_t line;
+    uint64_t fingerprint = 0;
+
+    while (procfs_next_line(&cur, &line)) {
+        unsigned int major, minor;
+        const char *name;
+        size_t len;
+        if (parse_device_id(&line, &major, &minor, &name, &len)) {
+            fingerprint = disk_index_mix(fingerprint, major, minor, name, len);
+        }
     }
+    return fingerprint;
+}
+
+// Rebuild the device index when devices were added or removed
+static bool refresh_index(void)
+{
+    uint64_t fingerprint = diskstats_fingerprint();
+    if (devices.table.slots && fingerprint == devices.fingerprint) return true;
+
+    disk_index_t fresh;
+    if (!disk_index_build(&fresh, &devices)) return false;
+    disk_index_free(&devices);
+    devices = fresh;
+
+    // Remember the set as /proc/diskstats lists it, so a device that
+    // sysfs does not show cannot force a rebuild every tick
+    devices.fingerprint = fingerprint;
+    log_info("Disk device index rebuilt: %zu devices", devices.table.live);
+    return true;
+}
+
+// Difference of a counter that may have wrapped or been reset
+static uint64_t counter_delta(uint64_t now, uint64_t prev)
+{
+    return now >= prev ? now - prev : 0;
+}
+
+// Rates of one device against its previous sample
+static void device_rates(disk_device_t *dev, const disk_counters_t *c,
+                         const disk_counters_t *prev, double seconds)
+{
+    uint64_t reads = counter_delta(c->reads, prev->reads);
+    uint64_t writes = counter_delta(c->writes, prev->writes);
+    uint64_t read_ms = counter_delta(c->read_ms, prev->read_ms);
+    uint64_t write_ms = counter_delta(c->write_ms, prev->write_ms);
+
+    dev->read_rate = counter_delta(c->sectors_read, prev->sectors_read) *
+                     (double)SECTOR_SIZE / 1024.0 / seconds;
+    dev->write_rate = counter_delta(c->sectors_written, prev->sectors_written) *
+                      (double)SECTOR_SIZE / 1024.0 / seconds;
+    dev->read_iops = reads / seconds;
+    dev->write_iops = writes / seconds;
+
+    // Time from submission to completion, averaged over completed requests
+    dev->read_await = reads ? (double)read_ms / reads : 0.0;
+    dev->write_await = writes ? (double)write_ms / writes : 0.0;
+    dev->await = reads + writes ? (double)(read_ms + write_ms) / (reads + writes) : 0.0;
+
+    dev->util = counter_delta(c->io_ticks, prev->io_ticks) / (seconds * 10.0);
+    if (dev->util > 100.0) dev->util = 100.0;
+}
+
+bool disk_metrics_reserve(disk_metrics_t *metrics, int n)
+{
+    if (n <= metrics->capacity) return true;
+
+    int capacity = metrics->capacity > 0 ? metrics->capacity : DISK_METRICS_INITIAL;
+    while (capacity < n) capacity *= 2;
 
-    char line[256];
-    unsigned long total_read = 0;
-    unsigned long total_write = 0;
-    time_t current_time = time(NULL);
-    double time_diff = difftime(current_time, disk_state.prev_time);
-    
-    if (time_diff <= 0) {
-        fclose(fp);
+    disk_device_t *array = realloc(metrics->devices, capacity * sizeof(disk_device_t));
+    if (!array) {
+        log_error("Memory allocation failed");
         return false;
     }
+    metrics->devices = array;
+    metrics->capacity = capacity;
+    return true;
+}
 
-    // Sum up all disk I/O
-    while (fgets(line, sizeof(line), fp)) {
-        unsigned long reads, writes;
-        
-        // Format: major minor name reads sectors_read writes sectors_written
-        if (sscanf(line, "%*d %*d %*s %lu %*u %lu %*u", &reads, &writes) == 2) {
-            total_read += reads;
-            total_write += writes;
-        }
+bool disk_metrics_copy(disk_metrics_t *dst, const disk_metrics_t *src)
+{
+    if (!disk_metrics_reserve(dst, src->count)) return false;
+
+    // Summary fields first, keeping dst's own array
+    disk_device_t *array = dst->devices;
+    int capacity = dst->capacity;
+    *dst = *src;
+    dst->devices = array;
+    dst->capacity = capacity;
+
+    if (src->count > 0) {
+        memcpy(dst->devices, src->devices, src->count * sizeof(disk_device_t));
     }
-    fclose(fp);
+    return true;
+}
 
-    // Calculate rates (sectors are typically 512 bytes)
-    metrics->read_rate = ((total_read - disk_state.prev_read) * 512) / (time_diff * 1024);
-    metrics->write_rate = ((total_write - disk_state.prev_write) * 512) / (time_diff * 1024);
-    
-    // Update totals (convert sectors to KB)
-    metrics->total_read += (total_read * 512) / 1024;
-    metrics->total_written += (total_write * 512) / 1024;
+void disk_metrics_free(disk_metrics_t *metrics)
+{
+    free(metrics->devices);
+    metrics->devices = NULL;
+    metrics->count = 0;
+    metrics->capacity = 0;
+}
+
+// Initialize disk collector
+bool disk_collector_init(void)
+{
+    show_partitions = config_get_bool("disk.partitions", false);
+    show_virtual = config_get_bool("disk.virtual", false);
 
-    // Save current values for next calculation
-    disk_state.prev_read = total_read;
-    disk_state.prev_write = total_write;
-    disk_state.prev_time = current_time;
+    if (!procfs_file_open(&diskstats_file, PROC_DISKSTATS) ||
+        !procfs_buf_init(&diskstats_buf, PROCFS_BUF_INITIAL)) {
+        log_error("Failed to open %s", PROC_DISKSTATS);
+        disk_collector_cleanup();
+        return false;
+    }
 
-    return true;
+    // Prime the index so the first published sample has rates
+    disk_metrics_t scratch = { 0 };
+    bool ok = disk_collector_collect(&scratch);
+    disk_metrics_free(&scratch);
+    return ok;
 }
- 
+
 // Collect disk statistics
 bool disk_collector_collect(disk_metrics_t *metrics)
 {
     if (!metrics) return false;
 
-    // Initialize metrics
-    memset(metrics, 0, sizeof(disk_metrics_t));
-
-    // Get disk I/O statistics
-    if (!read_global_disk_stats(metrics)) {
-        log_warning("Could not collect disk I/O stats");
+    if (!procfs_file_read(&diskstats_file, &diskstats_buf)) {
+        log_error("Failed to read %s", PROC_DISKSTATS);
         return false;
     }
+    if (!refresh_index()) return false;
+
+    uint64_t now = monotonic_ns();
+    uint64_t total_read = 0, total_written = 0;
+
+    metrics->read_rate = metrics->write_rate = 0.0;
+    metrics->read_iops = metrics->write_iops = 0.0;
+    metrics->count = 0;
+
+    procfs_cursor_t cur = procfs_cursor(&diskstats_buf);
+    procfs_cursor_t line;
+    while (procfs_next_line(&cur, &line)) {
+        unsigned int major, minor;
+        const char *name;
+        size_t len;
+        disk_counters_t c;
+        if (!parse_device_id(&line, &major, &minor, &name, &len) ||
+            !parse_counters(&line, &c)) {
+            continue;
+        }
+
+        disk_entry_t *e = disk_index_find(&devices, major, minor);
+        if (!e) continue;
+
+        disk_device_t dev = { 0 };
+        if (e->prev_ns != 0 && now > e->prev_ns) {
+            device_rates(&dev, &c, &e->prev, (double)(now - e->prev_ns) / NSEC_PER_SEC);
+        }
+        e->prev = c;
+        e->prev_ns = now;
+
+        // Physical whole disks make up the summary
+        if (!e->partition && !e->virtual_device) {
+            metrics->read_rate += dev.read_rate;
+            metrics->write_rate += dev.write_rate;
+            metrics->read_iops += dev.read_iops;
+            metrics->write_iops += dev.write_iops;
+            total_read += c.sectors_read;
+            total_written += c.sectors_written;
+        }
+
+        if ((e->partition && !show_partitions) || (e->virtual_device && !show_virtual)) continue;
+        if (!disk_metrics_reserve(metrics, metrics->count + 1)) continue;
+
+        memcpy(dev.name, e->name, sizeof(dev.name));
+        dev.partition = e->partition;
+        dev.virtual_device = e->virtual_device;
+        dev.sectors_read = c.sectors_read;
+        dev.sectors_written = c.sectors_written;
+        metrics->devices[metrics->count++] = dev;
+    }
 
+    metrics->total_read = total_read * SECTOR_SIZE / 1024;
+    metrics->total_written = total_written * SECTOR_SIZE / 1024;
     return true;
 }
- 
+
 // Clean up disk collector resources
 void disk_collector_cleanup(void)
 {
-    // No special cleanup needed
-}
\ No newline at end of file
+    procfs_file_close(&diskstats_file);
+    procfs_buf_free(&diskstats_buf);
+    disk_index_free(&devices);
+}
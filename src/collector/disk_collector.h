@@ -15,7 +15,16 @@
  // Collect disk statistics
  bool disk_collector_collect(disk_metrics_t *metrics);
  
+ // Make room for at least n devices, keeping existing entries
+ bool disk_metrics_reserve(disk_metrics_t *metrics, int n);
+ 
+ // Copy src into dst, growing dst's storage if needed
+ bool disk_metrics_copy(disk_metrics_t *dst, const disk_metrics_t *src);
+ 
+ // Release the device array
+ void disk_metrics_free(disk_metrics_t *metrics);
+ 
  // Clean up disk collector resources
  void disk_collector_cleanup(void);
  
- #endif /* DISK_COLLECTOR_H */
\ No newline at end of file
+ #endif /* DISK_COLLECTOR_H */
@@ -0,0 +1,126 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * disk_index.c - Block device index keyed by device number
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "disk_index.h"
+#include "../util/error_handler.h"
+
+#define SYS_CLASS_BLOCK "/sys/class/block"
+#define DISK_INDEX_INITIAL 64       // Minimum slot count (power of two)
+
+typedef struct {
+    unsigned int major;
+    unsigned int minor;
+} dev_key_t;
+
+static uint32_t hash_dev(unsigned int major, unsigned int minor)
+{
+    return (uint32_t)(((uint64_t)major << 20 | minor) * 0x9E3779B97F4A7C15ull >> 32);
+}
+
+static bool dev_equal(const void *entry, const void *key)
+{
+    const disk_entry_t *e = entry;
+    const dev_key_t *k = key;
+    return e->major == k->major && e->minor == k->minor;
+}
+
+// Insert or overwrite the entry for a device
+static bool insert(disk_index_t *index, const disk_entry_t *entry)
+{
+    dev_key_t key = { entry->major, entry->minor };
+    bool inserted;
+    disk_entry_t *e = hash_table_upsert(&index->table, hash_dev(key.major, key.minor), dev_equal,
+                                        &key, &inserted);
+    if (!e) return false;
+
+    // Everything but the slot header
+    hash_slot_t slot = e->slot;
+    *e = *entry;
+    e->slot = slot;
+    return true;
+}
+
+disk_entry_t *disk_index_find(const disk_index_t *index, unsigned int major, unsigned int minor)
+{
+    dev_key_t key = { major, minor };
+    return hash_table_find(&index->table, hash_dev(major, minor), dev_equal, &key);
+}
+
+// Describe one /sys/class/block entry
+static bool read_device(int dir, const char *name, disk_entry_t *entry)
+{
+    char path[MAX_DISK_NAME + 16];
+    char buf[256];
+
+    memset(entry, 0, sizeof(*entry));
+    if (strlen(name) >= MAX_DISK_NAME) return false;
+    strcpy(entry->name, name);
+
+    // "major:minor\n"
+    snprintf(path, sizeof(path), "%s/dev", name);
+    int fd = openat(dir, path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return false;
+    buf[n] = '\0';
+    if (sscanf(buf, "%u:%u", &entry->major, &entry->minor) != 2) return false;
+
+    snprintf(path, sizeof(path), "%s/partition", name);
+    entry->partition = faccessat(dir, path, F_OK, 0) == 0;
+
+    // The class entry links into the device tree
+    n = readlinkat(dir, name, buf, sizeof(buf) - 1);
+    if (n > 0) {
+        buf[n] = '\0';
+        entry->virtual_device = strstr(buf, "/devices/virtual/") != NULL;
+    }
+
+    return true;
+}
+
+bool disk_index_build(disk_index_t *index, const disk_index_t *old)
+{
+    index->fingerprint = 0;
+    if (!hash_table_init(&index->table, sizeof(disk_entry_t), DISK_INDEX_INITIAL)) return false;
+
+    DIR *dir = opendir(SYS_CLASS_BLOCK);
+    if (!dir) {
+        log_error("Failed to open %s", SYS_CLASS_BLOCK);
+        disk_index_free(index);
+        return false;
+    }
+
+    struct dirent *d;
+    while ((d = readdir(dir)) != NULL) {
+        if (d->d_name[0] == '.') continue;
+
+        disk_entry_t entry;
+        if (!read_device(dirfd(dir), d->d_name, &entry)) continue;
+
+        // Keep the last sample of a device that is still the same device
+        const disk_entry_t *prev = old ? disk_index_find(old, entry.major, entry.minor) : NULL;
+        if (prev && strcmp(prev->name, entry.name) == 0) {
+            entry.prev = prev->prev;
+            entry.prev_ns = prev->prev_ns;
+        }
+        if (!insert(index, &entry)) break;
+    }
+    closedir(dir);
+    return true;
+}
+
+void disk_index_free(disk_index_t *index)
+{
+    hash_table_free(&index->table);
+}
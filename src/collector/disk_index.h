@@ -0,0 +1,73 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * disk_index.h - Block device index keyed by device number
+ */
+
+#ifndef DISK_INDEX_H
+#define DISK_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/sysmon.h"
+#include "../util/hash_table.h"
+
+// Cumulative /proc/diskstats counters of one device
+typedef struct {
+    uint64_t reads;                 // Reads completed
+    uint64_t sectors_read;          // 512-byte sectors read
+    uint64_t read_ms;               // Time spent on reads
+    uint64_t writes;                // Writes completed
+    uint64_t sectors_written;
+    uint64_t write_ms;
+    uint64_t io_ticks;              // Time with at least one request in flight (ms)
+} disk_counters_t;
+
+// One block device and its state carried between ticks
+typedef struct {
+    hash_slot_t slot;
+    unsigned int major;
+    unsigned int minor;
+    bool partition;                 // Has a "partition" attribute in sysfs
+    bool virtual_device;            // Lives under /sys/devices/virtual (loop, dm, zram, ...)
+    char name[MAX_DISK_NAME];
+    disk_counters_t prev;           // Counters at the last sample
+    uint64_t prev_ns;               // CLOCK_MONOTONIC time of the last sample, 0 if none
+} disk_entry_t;
+
+// Open-addressing table, rebuilt wholesale when the device set changes
+typedef struct {
+    hash_table_t table;             // disk_entry_t by device number
+    uint64_t fingerprint;           // Device set the index was built for
+} disk_index_t;
+
+// Build the index from /sys/class/block, carrying the previous samples
+// of devices that are still present in old (which may be empty)
+bool disk_index_build(disk_index_t *index, const disk_index_t *old);
+
+// Entry for a device number, or NULL
+disk_entry_t *disk_index_find(const disk_index_t *index, unsigned int major, unsigned int minor);
+
+// Fold one device into a device-set fingerprint. The name (len bytes)
+// is included so a device number reused by another device still
+// changes the set.
+static inline uint64_t disk_index_mix(uint64_t fingerprint, unsigned int major, unsigned int minor,
+                                      const char *name, size_t len)
+{
+    // FNV-1a over the name
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 1099511628211ull;
+    }
+
+    uint64_t dev = (((uint64_t)major << 32 | minor) * 0x9E3779B97F4A7C15ull ^ h) *
+                   0x9E3779B97F4A7C15ull;
+    return fingerprint + (dev ^ (dev >> 29));
+}
+
+// Release index storage
+void disk_index_free(disk_index_t *index);
+
+#endif /* DISK_INDEX_H */
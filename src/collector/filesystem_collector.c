@@ -0,0 +1,379 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * filesystem_collector.c - Filesystem space and inode usage collector
+ * 
+ * The mount table is parsed from /proc/self/mountinfo at startup and
+ * again only after poll() reports POLLPRI on it, which the kernel raises
+ * whenever the mount namespace changes. Each tick then runs statvfs on
+ * the real filesystems in that table through statfs_worker, stopping
+ * once the time budget is used up; the next tick starts where this one
+ * stopped. The first call of a tick is made whatever the budget, so the
+ * sweep always moves on. A mount whose statvfs times out keeps its last
+ * values, is flagged as not responding and is left alone for a while.
+ * One whose statvfs fails (a stale NFS handle, a FUSE mount of another
+ * user) keeps its last values too and is retried after the same pause.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "filesystem_collector.h"
+#include "statfs_worker.h"
+#include "../util/config.h"
+#include "../util/error_handler.h"
+#include "../util/procfs_parse.h"
+#include "../util/time_util.h"
+
+#define PROC_MOUNTINFO "/proc/self/mountinfo"
+#define FILESYSTEM_METRICS_INITIAL 16   // Initial mount array capacity
+#define FS_RETRY_SECONDS 30             // Wait before asking a hung mount again
+
+// One mount from the mount table and its last statvfs answer
+typedef struct {
+    fs_mount_t info;
+    char *path;                     // Full mount point, unescaped
+    unsigned int major;
+    unsigned int minor;
+    bool sampled;                   // statvfs has answered at least once
+    bool hidden;                    // statvfs reported no blocks
+    int last_err;                   // errno of the last failed statvfs, 0 after a success
+    uint64_t retry_ns;              // Skipped until then after a timeout or failure
+} mount_t;
+
+static struct {
+    procfs_file_t file;             // /proc/self/mountinfo, also polled for changes
+    procfs_buf_t buf;
+    mount_t *mounts;
+    int count;
+    int next;                       // First mount to sample on the next tick
+    bool include_tmpfs;
+    uint64_t budget_ns;             // statvfs time per tick
+    uint64_t timeout_ns;            // Longest wait for a single statvfs
+} fs = { .file = { .fd = -1 } };
+
+// Filesystems without backing storage worth reporting
+static const char *const pseudo_types[] = {
+    "autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs", "debugfs",
+    "devpts", "efivarfs", "fusectl", "hugetlbfs", "mqueue", "nsfs", "proc",
+    "pstore", "ramfs", "rpc_pipefs", "securityfs", "selinuxfs", "sysfs",
+    "tracefs"
+};
+
+static bool is_pseudo(const char *type)
+{
+    if (!fs.include_tmpfs && (strcmp(type, "tmpfs") == 0 || strcmp(type, "devtmpfs") == 0)) {
+        return true;
+    }
+    for (size_t i = 0; i < sizeof(pseudo_types)/sizeof(pseudo_types[0]); i++) {
+        if (strcmp(type, pseudo_types[i]) == 0) return true;
+    }
+    return false;
+}
+
+// Copy a mountinfo field, undoing the kernel's \ooo octal escapes
+static void unescape(char *dst, size_t size, const char *src, size_t len)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < len && n + 1 < size; i++) {
+        if (src[i] == '\\' && i + 3 < len &&
+            (unsigned)(src[i + 1] - '0') < 8 && (unsigned)(src[i + 2] - '0') < 8 &&
+            (unsigned)(src[i + 3] - '0') < 8) {
+            dst[n++] = (char)((src[i + 1] - '0') * 64 + (src[i + 2] - '0') * 8 + (src[i + 3] - '0'));
+            i += 3;
+        } else {
+            dst[n++] = src[i];
+        }
+    }
+    dst[n] = '\0';
+}
+
+static void free_mounts(mount_t *mounts, int count)
+{
+    for (int i = 0; i < count; i++) free(mounts[i].path);
+    free(mounts);
+}
+
+// Earlier state of the same mount, if the previous table had it
+static const mount_t *find_previous(const mount_t *m)
+{
+    for (int i = 0; i < fs.count; i++) {
+        const mount_t *old = &fs.mounts[i];
+        if (old->major == m->major && old->minor == m->minor &&
+            strcmp(old->path, m->path) == 0) {
+            return old;
+        }
+    }
+    return NULL;
+}
+
+// Parse one line: "id parent major:minor root mount-point options
+// [optional fields] - type source super-options"
+static bool parse_mount(procfs_cursor_t *line, mount_t *m)
+{
+    const char *tok, *path;
+    size_t len, path_len;
+    char devno[32], type[MAX_FS_TYPE];
+
+    if (!procfs_skip_fields(line, 2) || !procfs_next_token(line, &tok, &len) ||
+        len >= sizeof(devno)) {
+        return false;
+    }
+    memcpy(devno, tok, len);
+    devno[len] = '\0';
+    if (sscanf(devno, "%u:%u", &m->major, &m->minor) != 2) return false;
+
+    if (!procfs_skip_fields(line, 1) || !procfs_next_token(line, &path, &path_len)) {
+        return false;
+    }
+
+    // Optional fields end at a lone "-"
+    do {
+        if (!procfs_next_token(line, &tok, &len)) return false;
+    } while (len != 1 || tok[0] != '-');
+
+    if (!procfs_next_token(line, &tok, &len) || len >= sizeof(type)) return false;
+    memcpy(type, tok, len);
+    type[len] = '\0';
+    if (is_pseudo(type)) return false;
+
+    m->path = malloc(path_len + 1);
+    if (!m->path) return false;
+    unescape(m->path, path_len + 1, path, path_len);
+    snprintf(m->info.fstype, sizeof(m->info.fstype), "%s", type);
+    snprintf(m->info.mount_point, sizeof(m->info.mount_point), "%s", m->path);
+    return true;
+}
+
+// True if an earlier entry already covers the same filesystem (bind mounts)
+static bool is_duplicate(const mount_t *mounts, int count, const mount_t *m)
+{
+    for (int i = 0; i < count; i++) {
+        if (mounts[i].major == m->major && mounts[i].minor == m->minor) return true;
+    }
+    return false;
+}
+
+// Re-read the mount table, keeping the last answer of mounts that stay
+static bool load_mounts(void)
+{
+    if (!procfs_file_read(&fs.file, &fs.buf)) {
+        log_error("Failed to read %s", PROC_MOUNTINFO);
+        return false;
+    }
+
+    mount_t *mounts = NULL;
+    int count = 0, capacity = 0;
+
+    procfs_cursor_t cur = procfs_cursor(&fs.buf);
+    procfs_cursor_t line;
+    while (procfs_next_line(&cur, &line)) {
+        mount_t m = { .info = { .responding = true } };
+        if (!parse_mount(&line, &m)) continue;
+        if (is_duplicate(mounts, count, &m)) {
+            free(m.path);
+            continue;
+        }
+
+        if (count == capacity) {
+            int grown = capacity ? capacity * 2 : FILESYSTEM_METRICS_INITIAL;
+            mount_t *array = realloc(mounts, grown * sizeof(mount_t));
+            if (!array) {
+                log_error("Memory allocation failed");
+                free(m.path);
+                free_mounts(mounts, count);
+                return false;
+            }
+            mounts = array;
+            capacity = grown;
+        }
+
+        const mount_t *old = find_previous(&m);
+        if (old) {
+            char *path = m.path;
+            m = *old;
+            m.path = path;
+        }
+        mounts[count++] = m;
+    }
+
+    free_mounts(fs.mounts, fs.count);
+    fs.mounts = mounts;
+    fs.count = count;
+    fs.next = 0;
+    log_info("Mount table loaded: %d filesystems", count);
+    return true;
+}
+
+// The kernel flags the mountinfo descriptor with POLLPRI after any mount
+// or unmount in this namespace
+static bool mounts_changed(void)
+{
+    struct pollfd pfd = { .fd = fs.file.fd, .events = POLLPRI };
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLPRI | POLLERR));
+}
+
+static void store_usage(mount_t *m, const struct statvfs *st)
+{
+    uint64_t frsize = st->f_frsize ? st->f_frsize : st->f_bsize;
+    fs_mount_t *info = &m->info;
+
+    // Filesystems with no blocks are pseudo filesystems the list missed
+    if (st->f_blocks == 0) {
+        m->hidden = true;
+        return;
+    }
+
+    info->total = st->f_blocks * frsize / 1024;
+    info->used = (st->f_blocks - st->f_bfree) * frsize / 1024;
+    info->available = st->f_bavail * frsize / 1024;
+    info->usage_percent = info->used + info->available > 0 ?
+                          info->used * 100.0 / (info->used + info->available) : 0.0;
+
+    info->inodes_total = st->f_files;
+    info->inodes_used = st->f_files >= st->f_ffree ? st->f_files - st->f_ffree : 0;
+    info->inode_percent = st->f_files > 0 ? info->inodes_used * 100.0 / st->f_files : 0.0;
+
+    info->responding = true;
+    m->sampled = true;
+    m->last_err = 0;
+}
+
+// statvfs as many mounts as the budget allows, but at least one,
+// round-robin across ticks
+static void sample_mounts(void)
+{
+    uint64_t now = monotonic_ns();
+    uint64_t deadline = now + fs.budget_ns;
+    bool called = false;
+
+    for (int k = 0; k < fs.count; k++) {
+        int i = (fs.next + k) % fs.count;
+        mount_t *m = &fs.mounts[i];
+        if (m->hidden || m->retry_ns > now) continue;
+
+        if (called && now >= deadline) {
+            fs.next = i;
+            return;
+        }
+        called = true;
+
+        struct statvfs st;
+        int err;
+        switch (statfs_worker_call(m->path, fs.timeout_ns, &st, &err)) {
+            case STATFS_OK:
+                store_usage(m, &st);
+                break;
+            case STATFS_FAILED:
+                // Often transient; log each new error once
+                if (err != m->last_err) {
+                    log_info("statvfs %s failed: %s", m->path, strerror(err));
+                    m->last_err = err;
+                }
+                m->retry_ns = monotonic_ns() + FS_RETRY_SECONDS * NSEC_PER_SEC;
+                break;
+            case STATFS_TIMEOUT:
+                log_warning("statvfs %s did not answer within %.0f ms", m->path,
+                            fs.timeout_ns / 1e6);
+                m->info.responding = false;
+                m->retry_ns = monotonic_ns() + FS_RETRY_SECONDS * NSEC_PER_SEC;
+                break;
+            case STATFS_BUSY:
+                // Every helper is stuck; try again next tick
+                fs.next = i;
+                return;
+        }
+        now = monotonic_ns();
+    }
+}
+
+bool filesystem_metrics_reserve(filesystem_metrics_t *metrics, int n)
+{
+    if (n <= metrics->capacity) return true;
+
+    int capacity = metrics->capacity > 0 ? metrics->capacity : FILESYSTEM_METRICS_INITIAL;
+    while (capacity < n) capacity *= 2;
+
+    fs_mount_t *array = realloc(metrics->mounts, capacity * sizeof(fs_mount_t));
+    if (!array) {
+        log_error("Memory allocation failed");
+        return false;
+    }
+    metrics->mounts = array;
+    metrics->capacity = capacity;
+    return true;
+}
+
+bool filesystem_metrics_copy(filesystem_metrics_t *dst, const filesystem_metrics_t *src)
+{
+    if (!filesystem_metrics_reserve(dst, src->count)) return false;
+
+    if (src->count > 0) {
+        memcpy(dst->mounts, src->mounts, src->count * sizeof(fs_mount_t));
+    }
+    dst->count = src->count;
+    return true;
+}
+
+void filesystem_metrics_free(filesystem_metrics_t *metrics)
+{
+    free(metrics->mounts);
+    metrics->mounts = NULL;
+    metrics->count = 0;
+    metrics->capacity = 0;
+}
+
+// Initialize filesystem collector
+bool filesystem_collector_init(void)
+{
+    fs.include_tmpfs = config_get_bool("filesystem.tmpfs", false);
+
+    double budget_ms = config_get_double("filesystem.budget_ms", 10.0);
+    double timeout_ms = config_get_double("filesystem.timeout_ms", 200.0);
+    fs.budget_ns = budget_ms > 0 ? (uint64_t)(budget_ms * 1e6) : 0;
+    fs.timeout_ns = timeout_ms > 0 ? (uint64_t)(timeout_ms * 1e6) : 1;
+
+    if (!procfs_file_open(&fs.file, PROC_MOUNTINFO) ||
+        !procfs_buf_init(&fs.buf, PROCFS_BUF_INITIAL)) {
+        log_error("Failed to open %s", PROC_MOUNTINFO);
+        filesystem_collector_cleanup();
+        return false;
+    }
+
+    // Consume the initial change notification along with the first read
+    mounts_changed();
+    return load_mounts();
+}
+
+// Collect filesystem usage
+bool filesystem_collector_collect(filesystem_metrics_t *metrics)
+{
+    if (!metrics) return false;
+
+    if (mounts_changed() && !load_mounts()) return false;
+    sample_mounts();
+
+    metrics->count = 0;
+    for (int i = 0; i < fs.count; i++) {
+        const mount_t *m = &fs.mounts[i];
+        if (m->hidden || (!m->sampled && m->info.responding)) continue;
+        if (!filesystem_metrics_reserve(metrics, metrics->count + 1)) break;
+        metrics->mounts[metrics->count++] = m->info;
+    }
+    return true;
+}
+
+// Clean up filesystem collector resources
+void filesystem_collector_cleanup(void)
+{
+    statfs_worker_shutdown();
+    procfs_file_close(&fs.file);
+    procfs_buf_free(&fs.buf);
+    free_mounts(fs.mounts, fs.count);
+    fs.mounts = NULL;
+    fs.count = 0;
+}
@@ -0,0 +1,30 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * filesystem_collector.h - Filesystem space and inode usage collector
+ */
+
+#ifndef FILESYSTEM_COLLECTOR_H
+#define FILESYSTEM_COLLECTOR_H
+
+#include "../include/sysmon.h"
+
+// Initialize filesystem collector
+bool filesystem_collector_init(void);
+
+// Collect filesystem usage
+bool filesystem_collector_collect(filesystem_metrics_t *metrics);
+
+// Make room for at least n mounts, keeping existing entries
+bool filesystem_metrics_reserve(filesystem_metrics_t *metrics, int n);
+
+// Copy src into dst, growing dst's storage if needed
+bool filesystem_metrics_copy(filesystem_metrics_t *dst, const filesystem_metrics_t *src);
+
+// Release the mount array
+void filesystem_metrics_free(filesystem_metrics_t *metrics);
+
+// Clean up filesystem collector resources
+void filesystem_collector_cleanup(void);
+
+#endif /* FILESYSTEM_COLLECTOR_H */
@@ -0,0 +1,81 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * iface_table.c - Persistent network interface table implementation
+ */
+
+#include <string.h>
+
+#include "iface_table.h"
+
+// Name as handed in by the backends, not NUL-terminated
+typedef struct {
+    const char *name;
+    size_t len;
+} iface_key_t;
+
+// FNV-1a over the interface name
+static uint32_t hash_name(const char *name, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool name_equal(const void *entry, const void *key)
+{
+    const iface_entry_t *e = entry;
+    const iface_key_t *k = key;
+    return memcmp(e->name, k->name, k->len) == 0 && e->name[k->len] == '\0';
+}
+
+bool iface_table_init(iface_table_t *table, size_t capacity)
+{
+    table->tick = 0;
+    return hash_table_init(&table->table, sizeof(iface_entry_t),
+                           capacity < IFACE_TABLE_INITIAL ? IFACE_TABLE_INITIAL : capacity);
+}
+
+void iface_table_free(iface_table_t *table)
+{
+    hash_table_free(&table->table);
+}
+
+void iface_table_begin_tick(iface_table_t *table)
+{
+    table->tick++;
+}
+
+iface_entry_t *iface_table_upsert(iface_table_t *table, const char *name, size_t len,
+                                  bool *inserted)
+{
+    if (len >= MAX_INTERFACE_NAME) return NULL;
+
+    iface_key_t key = { name, len };
+    iface_entry_t *e = hash_table_upsert(&table->table, hash_name(name, len), name_equal,
+                                         &key, inserted);
+    if (!e) return NULL;
+
+    if (*inserted) {
+        memcpy(e->name, name, len);
+        e->name[len] = '\0';
+    }
+    e->seen = table->tick;
+    return e;
+}
+
+void iface_table_end_tick(iface_table_t *table)
+{
+    for (size_t i = 0; i < table->table.capacity; i++) {
+        iface_entry_t *e = hash_table_slot(&table->table, i);
+        if (e->slot.state == HASH_SLOT_LIVE && e->seen != table->tick) {
+            hash_table_remove(&table->table, e);
+        }
+    }
+
+    // Give memory back after mass teardown of container interfaces
+    hash_table_shrink(&table->table, IFACE_TABLE_INITIAL);
+}
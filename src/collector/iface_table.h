@@ -0,0 +1,52 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * iface_table.h - Persistent network interface table keyed by name
+ */
+
+#ifndef IFACE_TABLE_H
+#define IFACE_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/sysmon.h"
+#include "../util/hash_table.h"
+
+#define IFACE_TABLE_INITIAL 64      // Initial and minimum slot count (power of two)
+
+// Per-interface state carried between ticks
+typedef struct {
+    hash_slot_t slot;
+    char name[MAX_INTERFACE_NAME];
+    net_counters_t prev;            // Counters at the last sample
+    uint64_t prev_ns;               // CLOCK_MONOTONIC time of the last sample
+    unsigned long seen;             // Tick in which the interface was last seen
+} iface_entry_t;
+
+// Present interfaces by name
+typedef struct {
+    hash_table_t table;
+    unsigned long tick;             // Current tick number
+} iface_table_t;
+
+// Allocate a table with at least capacity slots
+bool iface_table_init(iface_table_t *table, size_t capacity);
+
+// Release table storage
+void iface_table_free(iface_table_t *table);
+
+// Start a new tick; entries not seen before the matching end_tick are retired
+void iface_table_begin_tick(iface_table_t *table);
+
+// Find or insert the entry for name (len bytes, not NUL-terminated) and
+// mark it seen this tick. *inserted is set for a new interface. The
+// pointer is valid until the next upsert.
+iface_entry_t *iface_table_upsert(iface_table_t *table, const char *name, size_t len,
+                                  bool *inserted);
+
+// Tombstone interfaces that were not seen this tick, shrinking the
+// table after a large drop in interface count
+void iface_table_end_tick(iface_table_t *table);
+
+#endif /* IFACE_TABLE_H */
@@ -10,6 +10,7 @@
 
 #include "memory_collector.h"
 #include "../util/error_handler.h"
+#include "../util/procfs_parse.h"
 
 // File containing memory statistics
 #define PROC_MEMINFO_PATH "/proc/meminfo"
@@ -42,43 +43,49 @@ static const struct {
     [SWAP_FREE]    = {"SwapFree:", 9}
 };
 
+// /proc/meminfo kept open and re-read with pread each tick
+static procfs_file_t meminfo_file = { .fd = -1 };
+static procfs_buf_t meminfo_buf;
+
 bool memory_collector_init(void) {
-    // Verify we can read the memory info file
-    FILE *file = fopen(PROC_MEMINFO_PATH, "r");
-    if (file == NULL) {
+    if (!procfs_file_open(&meminfo_file, PROC_MEMINFO_PATH)) {
         log_error("Failed to open %s", PROC_MEMINFO_PATH);
         return false;
     }
-    fclose(file);
+    if (!procfs_buf_init(&meminfo_buf, PROCFS_BUF_INITIAL)) {
+        log_error("Memory allocation failed");
+        procfs_file_close(&meminfo_file);
+        return false;
+    }
     return true;
 }
 
-bool memory_collector_collect(memory_data *data) {
+bool memory_collector_collect(memory_metrics_t *data) {
     if (data == NULL) {
         log_error("Invalid data pointer");
         return false;
     }
 
-    FILE *file = fopen(PROC_MEMINFO_PATH, "r");
-    if (file == NULL) {
-        log_error("Failed to open %s", PROC_MEMINFO_PATH);
+    if (!procfs_file_read(&meminfo_file, &meminfo_buf)) {
+        log_error("Failed to read %s", PROC_MEMINFO_PATH);
         return false;
     }
 
     // Initialize all values to 0
     unsigned long values[NUM_FIELDS] = {0};
-    char line[256];
+    procfs_cursor_t cur = procfs_cursor(&meminfo_buf);
+    procfs_cursor_t line;
 
     // Read and parse each line of /proc/meminfo
-    while (fgets(line, sizeof(line), file)) {
+    while (procfs_next_line(&cur, &line)) {
         for (int i = 0; i < NUM_FIELDS; i++) {
-            if (strncmp(line, mem_fields[i].name, mem_fields[i].name_len) == 0) {
-                sscanf(line + mem_fields[i].name_len, "%lu", &values[i]);
+            if (procfs_consume(&line, mem_fields[i].name, mem_fields[i].name_len)) {
+                uint64_t value;
+                if (procfs_parse_u64(&line, &value)) values[i] = (unsigned long)value;
                 break;
             }
         }
     }
-    fclose(file);
 
     // Calculate derived values
     data->total = values[MEM_TOTAL];
@@ -105,6 +112,7 @@ bool memory_collector_collect(memory_data *data) {
 }
 
 void memory_collector_cleanup(void) {
-    // No resources to clean up
+    procfs_file_close(&meminfo_file);
+    procfs_buf_free(&meminfo_buf);
 }
 
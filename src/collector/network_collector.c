@@ -8,173 +8,278 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <dirent.h>
-#include <time.h>
-#include <ctype.h>
-#include <limits.h>
- 
+
 #include "network_collector.h"
+#include "iface_table.h"
+#include "rtnl_link.h"
+#include "../util/config.h"
 #include "../util/error_handler.h"
+#include "../util/procfs_parse.h"
+#include "../util/time_util.h"
 
 #define PROC_NET_DEV "/proc/net/dev"
-#define MAX_INTERFACE_NAME 16
-#define STATS_FILE_LEN 256
+#define NETWORK_METRICS_INITIAL 16  // Initial interface array capacity
+
+// Every interface seen, keyed by name
+static iface_table_t ifaces;
+
+// Where interface counters come from
+typedef enum {
+    NET_BACKEND_PROCFS,             // Parse /proc/net/dev text
+    NET_BACKEND_NETLINK             // RTM_GETLINK dump with IFLA_STATS64
+} net_backend_t;
+
+static net_backend_t backend = NET_BACKEND_PROCFS;
 
-// Previous readings for rate calculation
+// State threaded through one collection pass
 typedef struct {
-    unsigned long rx_bytes; // Received bytes
-    unsigned long tx_bytes; // Transmitted bytes
-    time_t last_update; 
-} interface_prev_t;
-
-static interface_prev_t *prev_stats = NULL;
-static int num_interfaces = 0;
-
-// Helper to trim whitespace from interface name
-static void trim_whitespace(char *str) {
-    char *end;
-    while(isspace((unsigned char)*str)) str++;
-    end = str + strlen(str) - 1;
-    while(end > str && isspace((unsigned char)*end)) end--;
-    *(end+1) = '\0';
+    network_metrics_t *metrics;
+    uint64_t now;
+    int primary;                    // Index of the busiest non-loopback interface
+    double primary_rate;
+    uint64_t primary_bytes;
+} collect_pass_t;
+
+// /proc/net/dev kept open and re-read with pread each tick
+static procfs_file_t netdev_file = { .fd = -1 };
+static procfs_buf_t netdev_buf;
+
+// Skip the two header lines of /proc/net/dev
+static bool skip_header(procfs_cursor_t *cur) {
+    procfs_cursor_t line;
+    return procfs_next_line(cur, &line) && procfs_next_line(cur, &line);
 }
 
-bool network_collector_init(void) {
-    // Count number of network interfaces
-    FILE *file = fopen(PROC_NET_DEV, "r");
-    if (!file) {
-        log_error("Failed to open %s", PROC_NET_DEV);
-        return false;
-    }
+// Split "  name: counters..." into the name and a cursor on the counters
+static bool parse_interface_name(procfs_cursor_t *line, const char **name, size_t *len) {
+    procfs_skip_blanks(line);
 
-    // Skip header lines
-    char line[256];
-    for (int i = 0; i < 2; i++) {
-        if (!fgets(line, sizeof(line), file)) {
-            fclose(file);
-            log_error("Invalid format in %s", PROC_NET_DEV);
-            return false;
-        }
-    }
+    const char *colon = memchr(line->p, ':', (size_t)(line->end - line->p));
+    if (!colon) return false;
 
-    // Count interfaces
-    num_interfaces = 0;
-    while (fgets(line, sizeof(line), file)) {
-        num_interfaces++;
-    }
-    fclose(file);
+    *name = line->p;
+    *len = (size_t)(colon - line->p);
+    if (*len == 0 || *len >= MAX_INTERFACE_NAME) return false;
 
-    if (num_interfaces == 0) {
-        log_warning("No network interfaces found");
-        return true;  // Not a fatal error
-    }
+    line->p = colon + 1;
+    return true;
+}
 
-    // Allocate memory for previous stats
-    prev_stats = calloc(num_interfaces, sizeof(interface_prev_t));
-    if (!prev_stats) {
+// Parse the sixteen counters that follow the interface name
+static bool parse_counters(procfs_cursor_t *line, net_counters_t *c) {
+    // Receive: bytes packets errs drop fifo frame compressed multicast
+    // Transmit: bytes packets errs drop fifo colls carrier compressed
+    return procfs_parse_u64(line, &c->rx_bytes) &&
+           procfs_parse_u64(line, &c->rx_packets) &&
+           procfs_parse_u64(line, &c->rx_errors) &&
+           procfs_parse_u64(line, &c->rx_dropped) &&
+           procfs_skip_fields(line, 4) &&
+           procfs_parse_u64(line, &c->tx_bytes) &&
+           procfs_parse_u64(line, &c->tx_packets) &&
+           procfs_parse_u64(line, &c->tx_errors) &&
+           procfs_parse_u64(line, &c->tx_dropped);
+}
+
+// Per-second rate of a 64-bit counter. A counter that went backwards was
+// reset (interface recreated under the same name), so it restarts at 0.
+static double counter_rate(uint64_t now, uint64_t prev, double seconds) {
+    return now >= prev ? (double)(now - prev) / seconds : 0.0;
+}
+
+bool network_metrics_reserve(network_metrics_t *metrics, int n) {
+    if (n <= metrics->capacity) return true;
+
+    int capacity = metrics->capacity > 0 ? metrics->capacity : NETWORK_METRICS_INITIAL;
+    while (capacity < n) capacity *= 2;
+
+    net_interface_t *interfaces = realloc(metrics->interfaces, capacity * sizeof(net_interface_t));
+    if (!interfaces) {
         log_error("Memory allocation failed");
         return false;
     }
+    metrics->interfaces = interfaces;
+    metrics->capacity = capacity;
+    return true;
+}
 
-    // Get initial readings
-    network_metrics_t dummy;
-    return network_collector_collect(&dummy);
+bool network_metrics_copy(network_metrics_t *dst, const network_metrics_t *src) {
+    if (!network_metrics_reserve(dst, src->count)) return false;
+
+    // Summary fields first, keeping dst's own array
+    net_interface_t *interfaces = dst->interfaces;
+    int capacity = dst->capacity;
+    *dst = *src;
+    dst->interfaces = interfaces;
+    dst->capacity = capacity;
+
+    if (src->count > 0) {
+        memcpy(dst->interfaces, src->interfaces, src->count * sizeof(net_interface_t));
+    }
+    return true;
 }
 
-bool network_collector_collect(network_metrics_t *metrics) {
-    if (!metrics) return false;
+void network_metrics_free(network_metrics_t *metrics) {
+    free(metrics->interfaces);
+    metrics->interfaces = NULL;
+    metrics->count = 0;
+    metrics->capacity = 0;
+}
 
-    FILE *fp = fopen(PROC_NET_DEV, "r");
-    if (!fp) {
-        log_error("Failed to open network stats");
-        return false;
+// Open the configured backend, falling back to /proc/net/dev
+static bool open_backend(void) {
+    const char *name = config_get_string("network.backend", "auto");
+
+    if (strcmp(name, "procfs") != 0) {
+        if (rtnl_link_open()) {
+            backend = NET_BACKEND_NETLINK;
+            log_info("Network statistics from rtnetlink");
+            return true;
+        }
+        if (strcmp(name, "netlink") == 0) {
+            log_warning("rtnetlink unavailable, falling back to %s", PROC_NET_DEV);
+        } else if (strcmp(name, "auto") != 0) {
+            log_warning("Unknown network.backend '%s', using auto", name);
+        }
     }
 
-    memset(metrics, 0, sizeof(network_metrics_t));
-    time_t now = time(NULL);
-    double time_diff = 1.0; // Default to 1s if no previous data
+    backend = NET_BACKEND_PROCFS;
+    if (!procfs_file_open(&netdev_file, PROC_NET_DEV) ||
+        !procfs_buf_init(&netdev_buf, PROCFS_BUF_INITIAL)) {
+        log_error("Failed to open %s", PROC_NET_DEV);
+        return false;
+    }
+    log_info("Network statistics from %s", PROC_NET_DEV);
+    return true;
+}
 
-    // Calculate time difference if we have previous data
-    if (prev_stats[0].last_update > 0) {
-        time_diff = difftime(now, prev_stats[0].last_update);
-        if (time_diff <= 0) time_diff = 1.0; // Prevent division by zero
+bool network_collector_init(void) {
+    if (!iface_table_init(&ifaces, IFACE_TABLE_INITIAL) || !open_backend()) {
+        network_collector_cleanup();
+        return false;
     }
 
-    // Skip header lines
-    char line[256];
-    for (int i = 0; i < 2; i++) fgets(line, sizeof(line), fp);
+    // Prime the table so the first published sample has rates
+    network_metrics_t scratch = { 0 };
+    bool ok = network_collector_collect(&scratch);
+    network_metrics_free(&scratch);
+    return ok;
+}
 
-    unsigned long max_rx = 0;
-    char primary_iface[MAX_INTERFACE_NAME] = "";
+// Record one interface: rates against its own last sample, and the
+// running choice of primary interface
+static void account_interface(const char *name, size_t len,
+                              const net_counters_t *counters, void *ctx) {
+    collect_pass_t *pass = ctx;
+    network_metrics_t *metrics = pass->metrics;
 
-    while (fgets(line, sizeof(line), fp)) {
-        char *colon = strchr(line, ':');
-        if (!colon) continue;
+    bool inserted;
+    iface_entry_t *e = iface_table_upsert(&ifaces, name, len, &inserted);
+    if (!e || !network_metrics_reserve(metrics, metrics->count + 1)) return;
 
-        // Extract interface name
-        char iface[MAX_INTERFACE_NAME];
-        strncpy(iface, line, colon - line);
-        iface[colon - line] = '\0';
-        trim_whitespace(iface);
+    net_interface_t *iface = &metrics->interfaces[metrics->count];
+    memcpy(iface->name, e->name, sizeof(iface->name));
+    iface->counters = *counters;
+    iface->rx_rate = iface->tx_rate = 0.0;
+    iface->rx_packet_rate = iface->tx_packet_rate = 0.0;
 
-        // Skip loopback unless it's the only interface
-        if (strcmp(iface, "lo") == 0) continue;
+    // Rates only against this interface's own previous sample
+    if (!inserted && pass->now > e->prev_ns) {
+        double seconds = (double)(pass->now - e->prev_ns) / NSEC_PER_SEC;
+        iface->rx_rate = counter_rate(counters->rx_bytes, e->prev.rx_bytes, seconds) / 1024.0;
+        iface->tx_rate = counter_rate(counters->tx_bytes, e->prev.tx_bytes, seconds) / 1024.0;
+        iface->rx_packet_rate = counter_rate(counters->rx_packets, e->prev.rx_packets, seconds);
+        iface->tx_packet_rate = counter_rate(counters->tx_packets, e->prev.tx_packets, seconds);
+    }
+    e->prev = *counters;
+    e->prev_ns = pass->now;
 
-        // Parse statistics
-        unsigned long rx_bytes, tx_bytes;
-        if (sscanf(colon+1, "%lu %*u %*u %*u %*u %*u %*u %*u %lu",
-                  &rx_bytes, &tx_bytes) != 2) {
-            continue;
+    // Busiest non-loopback interface right now, ties broken by traffic
+    // so far, which also picks one on the first sample
+    if (strcmp(iface->name, "lo") != 0) {
+        double rate = iface->rx_rate + iface->tx_rate;
+        uint64_t bytes = counters->rx_bytes + counters->tx_bytes;
+        if (rate > pass->primary_rate ||
+            (rate == pass->primary_rate && bytes > pass->primary_bytes)) {
+            pass->primary = metrics->count;
+            pass->primary_rate = rate;
+            pass->primary_bytes = bytes;
         }
+    }
+    metrics->count++;
+}
 
-        // Track interface with most traffic
-        if (rx_bytes > max_rx) {
-            max_rx = rx_bytes;
-            strncpy(primary_iface, iface, MAX_INTERFACE_NAME);
-            
-            // Only calculate rates if we have previous data
-            if (prev_stats[0].last_update > 0) {
-                // Handle counter wrap-around (32-bit systems)
-                if (rx_bytes < prev_stats[0].rx_bytes) {
-                    metrics->rx_rate = ((ULONG_MAX - prev_stats[0].rx_bytes) + rx_bytes) / (time_diff * 1024);
-                } else {
-                    metrics->rx_rate = (rx_bytes - prev_stats[0].rx_bytes) / (time_diff * 1024);
-                }
-
-                if (tx_bytes < prev_stats[0].tx_bytes) {
-                    metrics->tx_rate = ((ULONG_MAX - prev_stats[0].tx_bytes) + tx_bytes) / (time_diff * 1024);
-                } else {
-                    metrics->tx_rate = (tx_bytes - prev_stats[0].tx_bytes) / (time_diff * 1024);
-                }
-            }
-
-            strncpy(metrics->interface, iface, MAX_INTERFACE_NAME);
-            metrics->rx_bytes = rx_bytes;
-            metrics->tx_bytes = tx_bytes;
-            metrics->total_rx = rx_bytes / 1024;  // KB
-            metrics->total_tx = tx_bytes / 1024;  // KB
+// Walk /proc/net/dev
+static bool read_proc_net_dev(iface_visit_fn visit, void *ctx) {
+    if (!procfs_file_read(&netdev_file, &netdev_buf)) {
+        log_error("Failed to read network stats");
+        return false;
+    }
+
+    procfs_cursor_t cur = procfs_cursor(&netdev_buf);
+    procfs_cursor_t line;
+    if (!skip_header(&cur)) return false;
+
+    while (procfs_next_line(&cur, &line)) {
+        const char *name;
+        size_t len;
+        net_counters_t counters;
+        if (parse_interface_name(&line, &name, &len) &&
+            parse_counters(&line, &counters)) {
+            visit(name, len, &counters, ctx);
         }
     }
-    fclose(fp);
+    return true;
+}
+
+bool network_collector_collect(network_metrics_t *metrics) {
+    if (!metrics) return false;
+
+    collect_pass_t pass = {
+        .metrics = metrics,
+        .now = monotonic_ns(),
+        .primary = -1,
+        .primary_rate = -1.0
+    };
 
-    // Update previous stats
-    if (primary_iface[0] != '\0') {
-        prev_stats[0].rx_bytes = metrics->rx_bytes;
-        prev_stats[0].tx_bytes = metrics->tx_bytes;
-        prev_stats[0].last_update = now;
+    metrics->count = 0;
+    iface_table_begin_tick(&ifaces);
+
+    bool ok = backend == NET_BACKEND_NETLINK ?
+              rtnl_link_dump(account_interface, &pass) :
+              read_proc_net_dev(account_interface, &pass);
+    if (!ok) {
+        // Keep the table as it was rather than retiring every interface
+        return false;
     }
-    // Fallback to loopback if no other interfaces
-    else if (num_interfaces == 1) {
-        strncpy(metrics->interface, "lo", MAX_INTERFACE_NAME);
+
+    iface_table_end_tick(&ifaces);
+
+    // Fall back to loopback if it is the only interface
+    int primary = pass.primary;
+    if (primary == -1 && metrics->count > 0) primary = 0;
+
+    if (primary >= 0) {
+        const net_interface_t *p = &metrics->interfaces[primary];
+        memcpy(metrics->interface, p->name, sizeof(metrics->interface));
+        metrics->rx_rate = p->rx_rate;
+        metrics->tx_rate = p->tx_rate;
+        metrics->rx_bytes = p->counters.rx_bytes;
+        metrics->tx_bytes = p->counters.tx_bytes;
+        metrics->total_rx = p->counters.rx_bytes / 1024;  // KB
+        metrics->total_tx = p->counters.tx_bytes / 1024;  // KB
+    } else {
+        metrics->interface[0] = '\0';
+        metrics->rx_rate = metrics->tx_rate = 0.0;
+        metrics->rx_bytes = metrics->tx_bytes = 0;
+        metrics->total_rx = metrics->total_tx = 0;
     }
 
     return true;
 }
 
 void network_collector_cleanup(void) {
-    if (prev_stats) {
-        free(prev_stats);
-        prev_stats = NULL;
-    }
-    num_interfaces = 0;
-}
\ No newline at end of file
+    rtnl_link_close();
+    procfs_file_close(&netdev_file);
+    procfs_buf_free(&netdev_buf);
+    iface_table_free(&ifaces);
+}
@@ -15,6 +15,15 @@ bool network_collector_init(void);
 // Collect network statistics
 bool network_collector_collect(network_metrics_t *metrics);
 
+// Make room for at least n interfaces, keeping existing entries
+bool network_metrics_reserve(network_metrics_t *metrics, int n);
+
+// Copy src into dst, growing dst's storage if needed
+bool network_metrics_copy(network_metrics_t *dst, const network_metrics_t *src);
+
+// Release the interface array
+void network_metrics_free(network_metrics_t *metrics);
+
 // Clean up network collector resources
 void network_collector_cleanup(void);
 
@@ -0,0 +1,185 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * proc_events.c - Process fork/exec/exit events from the netlink proc connector
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+
+#include "proc_events.h"
+#include "../util/error_handler.h"
+
+#define PROC_EVENTS_RCVBUF (4 * 1024 * 1024)   // Absorbs fork storms between drains
+#define PROC_EVENTS_ACK_MS 250                  // Wait for the subscription ack
+
+static int nl_fd = -1;
+
+// Send a listen/ignore request to the connector
+static bool send_mcast_op(enum proc_cn_mcast_op op)
+{
+    _Alignas(struct nlmsghdr) char buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(op))];
+    memset(buf, 0, sizeof(buf));
+
+    struct nlmsghdr *nlh = (struct nlmsghdr *)buf;
+    nlh->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+    nlh->nlmsg_type = NLMSG_DONE;
+    nlh->nlmsg_pid = getpid();
+
+    struct cn_msg *cn = NLMSG_DATA(nlh);
+    cn->id.idx = CN_IDX_PROC;
+    cn->id.val = CN_VAL_PROC;
+    cn->len = sizeof(op);
+    memcpy(cn->data, &op, sizeof(op));
+
+    return send(nl_fd, buf, nlh->nlmsg_len, 0) == (ssize_t)nlh->nlmsg_len;
+}
+
+// Walk one datagram. Returns false if it reports an overrun.
+static bool handle_datagram(const char *buf, size_t len, proc_event_fn fn, void *ctx,
+                            bool *acked)
+{
+    bool ok = true;
+
+    for (const struct nlmsghdr *nlh = (const struct nlmsghdr *)buf;
+         NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+        if (nlh->nlmsg_type == NLMSG_NOOP) continue;
+        if (nlh->nlmsg_type == NLMSG_ERROR || nlh->nlmsg_type == NLMSG_OVERRUN) {
+            ok = false;
+            continue;
+        }
+
+        const struct cn_msg *cn = NLMSG_DATA(nlh);
+        if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC) continue;
+
+        const struct proc_event *ev = (const struct proc_event *)cn->data;
+        switch (ev->what) {
+            case PROC_EVENT_NONE:
+                // Subscription acknowledgement
+                if (acked && ev->event_data.ack.err == 0) *acked = true;
+                break;
+            case PROC_EVENT_FORK:
+                // Thread creation shows up as a fork inside the same group
+                if (fn && ev->event_data.fork.child_pid == ev->event_data.fork.child_tgid) {
+                    fn(PROC_EV_FORK, ev->event_data.fork.child_tgid, ctx);
+                }
+                break;
+            case PROC_EVENT_EXEC:
+                if (fn) fn(PROC_EV_EXEC, ev->event_data.exec.process_tgid, ctx);
+                break;
+            case PROC_EVENT_EXIT:
+                if (fn && ev->event_data.exit.process_pid == ev->event_data.exit.process_tgid) {
+                    fn(PROC_EV_EXIT, ev->event_data.exit.process_tgid, ctx);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return ok;
+}
+
+// Read every queued datagram from the socket
+static bool read_events(proc_event_fn fn, void *ctx, bool *acked)
+{
+    _Alignas(struct nlmsghdr) char buf[8192];
+    bool ok = true;
+
+    for (;;) {
+        struct sockaddr_nl from;
+        socklen_t from_len = sizeof(from);
+
+        ssize_t n = recvfrom(nl_fd, buf, sizeof(buf), MSG_DONTWAIT,
+                             (struct sockaddr *)&from, &from_len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ENOBUFS) {
+                // The receive queue overflowed and events were lost
+                ok = false;
+                continue;
+            }
+            break;
+        }
+        if (n == 0) break;
+
+        // Only the kernel may speak for the connector
+        if (from.nl_pid != 0) continue;
+
+        if (!handle_datagram(buf, (size_t)n, fn, ctx, acked)) ok = false;
+    }
+    return ok;
+}
+
+bool proc_events_open(void)
+{
+    nl_fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (nl_fd == -1) {
+        log_warning("Process connector unavailable: %s", strerror(errno));
+        return false;
+    }
+
+    int size = PROC_EVENTS_RCVBUF;
+    if (setsockopt(nl_fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) == -1) {
+        setsockopt(nl_fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+
+    struct sockaddr_nl addr = {
+        .nl_family = AF_NETLINK,
+        .nl_groups = CN_IDX_PROC,
+        .nl_pid = 0                 // Let the kernel pick a port id
+    };
+    if (bind(nl_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        log_warning("Process connector bind failed: %s", strerror(errno));
+        proc_events_close();
+        return false;
+    }
+
+    if (!send_mcast_op(PROC_CN_MCAST_LISTEN)) {
+        log_warning("Process connector subscribe failed: %s", strerror(errno));
+        proc_events_close();
+        return false;
+    }
+
+    // Outside the initial namespaces the kernel ignores the request
+    // silently, so insist on seeing the acknowledgement
+    bool acked = false;
+    struct pollfd pfd = { .fd = nl_fd, .events = POLLIN };
+    while (!acked && poll(&pfd, 1, PROC_EVENTS_ACK_MS) > 0) {
+        read_events(NULL, NULL, &acked);
+    }
+    if (!acked) {
+        log_warning("Process connector did not acknowledge the subscription");
+        proc_events_close();
+        return false;
+    }
+
+    return true;
+}
+
+int proc_events_fd(void)
+{
+    return nl_fd;
+}
+
+bool proc_events_drain(proc_event_fn fn, void *ctx)
+{
+    if (nl_fd == -1) return false;
+    return read_events(fn, ctx, NULL);
+}
+
+void proc_events_close(void)
+{
+    if (nl_fd == -1) return;
+
+    send_mcast_op(PROC_CN_MCAST_IGNORE);
+    close(nl_fd);
+    nl_fd = -1;
+}
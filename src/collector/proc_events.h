@@ -0,0 +1,37 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * proc_events.h - Process fork/exec/exit events from the netlink proc connector
+ */
+
+#ifndef PROC_EVENTS_H
+#define PROC_EVENTS_H
+
+#include <sys/types.h>
+
+#include "../include/sysmon.h"
+
+typedef enum {
+    PROC_EV_FORK,                   // New process (not a new thread)
+    PROC_EV_EXEC,                   // Process replaced its image
+    PROC_EV_EXIT                    // Process (thread group leader) exited
+} proc_event_kind_t;
+
+// Called once per event with the thread group id it concerns
+typedef void (*proc_event_fn)(proc_event_kind_t kind, pid_t pid, void *ctx);
+
+// Subscribe to process events. Fails without CAP_NET_ADMIN or when the
+// kernel lacks the proc connector.
+bool proc_events_open(void);
+
+// Descriptor that becomes readable when events are pending, or -1
+int proc_events_fd(void);
+
+// Deliver every pending event. Returns false if the kernel dropped events
+// since the last call; the caller must then resynchronise from /proc.
+bool proc_events_drain(proc_event_fn fn, void *ctx);
+
+// Unsubscribe and close the socket
+void proc_events_close(void);
+
+#endif /* PROC_EVENTS_H */
@@ -4,91 +4,705 @@
  * process_collector.c - Process statistics collector implementation
  */
 
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
 #include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <ctype.h>
+#include <sys/resource.h>
 #include <sys/stat.h> 
 #include <time.h> 
 
 #include "process_collector.h"
+#include "process_table.h"
+#include "proc_events.h"
+#include "sock_index.h"
+#include "system_stat.h"
+#include "../util/config.h"
 #include "../util/error_handler.h"
 #include "../util/logger.h"
+#include "../util/procfs_parse.h"
+#include "../util/thread_pool.h"
+#include "../util/time_util.h"
  
 static unsigned long long prev_total_jiffies = 0; // Previous total CPU jiffies (time units)
 static unsigned long long prev_work_jiffies = 0;  // Previous work CPU jiffies (time units)
-static process_info_t prev_processes[MAX_PROCESSES];
-static int prev_process_count = 0;
 
-static bool is_kernel_thread(pid_t pid) {
+// Per-process CPU counters carried between ticks, keyed by (pid, starttime)
+static process_table_t table;
+
+#define PF_KTHREAD 0x00200000       // Task flag set on kernel threads
+#define FD_CACHE_RESERVE 256        // Descriptors left free for everything else
+#define DIRENT_BUF_INITIAL 65536    // Initial getdents64 buffer size
+#define SCAN_ITEMS_INITIAL 1024     // Initial PID list capacity
+#define EXITED_MAX 4096             // Exited processes reported per tick
+
+// One PID to scan, with its cached descriptor handed over from the table
+typedef struct {
+    pid_t pid;
+    int cached_fd;
+} scan_item_t;
+
+// Result of reading one PID
+typedef struct {
+    process_info_t info;
+    int fd;                         // Descriptor to keep cached, or -1
+    int fd_count;                   // Open descriptors, -1 if unknown or not tracked
+    bool kernel_thread;
+} scan_result_t;
+
+// Per-worker read buffer and output slab; only its own worker writes here
+typedef struct {
+    procfs_buf_t buf;
+    scan_result_t *results;
+    size_t count;
+    size_t capacity;
+} scan_slab_t;
+
+// /proc scan state
+static struct {
+    int dir_fd;                     // /proc, rewound before each scan
+    char *dirents;                  // getdents64 buffer, sized to read /proc in one call
+    size_t dirents_size;
+    scan_item_t *items;             // PIDs found by the current scan
+    size_t item_count;
+    size_t item_capacity;
+    thread_pool_t pool;
+    scan_slab_t slabs[THREAD_POOL_MAX];
+    atomic_long fd_budget;          // Descriptors the workers may still keep open
+} scan = { .dir_fd = -1 };
+
+// One /proc/[pid]/io read queued by the merge; only the worker that
+// takes it writes the result fields
+typedef struct {
+    int index;                      // Position in metrics->processes
+    bool ok;                        // io holds the counters
+    bool denied;                    // Not readable by us (another user's process)
+    proc_io_t io;
+} io_item_t;
+
+// Lazy /proc/[pid]/io sampling. A process that used no CPU time since its
+// last sample cannot have issued I/O, so only processes that ran, last
+// tick's top entries and new processes are read; an idle process keeps
+// its counters and just moves their timestamp forward. Sorting by I/O
+// reads every process instead.
+static struct {
+    io_item_t *items;
+    size_t count;
+    size_t capacity;
+    atomic_int requested_sort;      // process_sort_t, set by the UI thread
+} io_scan;
+
+// One /proc/[pid]/smaps_rollup read; only the worker that takes it
+// writes the result fields
+typedef struct {
+    pid_t pid;
+    unsigned long long starttime;
+    bool ok;                        // smaps holds the figures
+    bool denied;                    // Not readable by us (another user's process)
+    proc_smaps_t smaps;
+} smaps_item_t;
+
+// PSS/USS/swap for the rows on screen. The kernel walks every mapping to
+// build smaps_rollup, so only the rows the UI published are read, and
+// only once their cached figures are older than the TTL.
+static struct {
+    pthread_mutex_t lock;           // Guards rows and row_count
+    smaps_item_t rows[PROCESS_VISIBLE_MAX];   // Published by the UI thread; pid and starttime only
+    int row_count;
+    smaps_item_t items[PROCESS_VISIBLE_MAX];  // Reads queued by the current scan
+    size_t count;
+    uint64_t ttl_ns;
+} smaps_scan = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// Compact sort key; selection compares these instead of whole process_info_t
+typedef struct {
+    double primary;                 // CPU% or I/O rate, depending on the order
+    double secondary;               // MEM% or CPU%
+    pid_t pid;
+    int index;                      // Position in metrics->processes
+} rank_key_t;
+
+// Top-K selection state
+static struct {
+    rank_key_t *keys;
+    size_t capacity;
+    rank_key_t heap[PROCESS_TOP_K]; // Worst selected entry at the root
+    int seeds[PROCESS_TOP_K];       // This tick's index of last tick's rank r, or -1
+    process_info_t top[PROCESS_TOP_K];
+    unsigned long generation;
+} rank;
+
+// A process that exited between ticks, with the CPU time it used since
+// its last sample
+typedef struct {
+    process_info_t info;
+    unsigned long long jiffies;
+} exited_process_t;
+
+// Event-driven mode (process.events): the table follows fork/exec/exit
+// from the proc connector and ticks re-read only its live entries
+static struct {
+    bool enabled;
+    bool resync;                    // Rescan /proc on the next tick
+    exited_process_t *exited;       // Exited since the last tick
+    int exited_count;
+    int exited_capacity;
+    process_info_t *born;           // First sample of processes started since the last tick
+    int born_count;
+    int born_capacity;
+} events;
+
+// Per-process socket attribution (process.sockets)
+static bool sockets_enabled = false;
+static uint64_t socket_budget_ns = 0;
+
+// Keep /proc/[pid]/stat descriptors open across ticks
+static bool fd_cache_enabled = false;
+static size_t fd_cache_limit = 0;
+
+static unsigned long page_size_kb = 4;
+
+// Read /proc/[pid]/stat into buf. A cached descriptor is re-read with
+// pread; if it is stale (the process exited) it is closed and the path
+// is opened again. *fd_out receives the descriptor to keep, or -1.
+static bool read_stat_file(pid_t pid, int cached_fd, bool keep_open, int *fd_out,
+                           procfs_buf_t *buf) {
+    *fd_out = -1;
+
+    if (cached_fd != -1) {
+        if (procfs_read_fd_single(cached_fd, buf) && buf->len > 0) {
+            *fd_out = cached_fd;
+            return true;
+        }
+        close(cached_fd);
+    }
+
     char stat_path[64];
     snprintf(stat_path, sizeof(stat_path), "/proc/%d/stat", pid);
 
-    FILE *fp = fopen(stat_path, "r");
-    if (!fp) return true;  // Assume kernel thread if file cannot be opened
+    int fd = open(stat_path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
 
-    char state;
-    if (fscanf(fp, "%*d %*s %c", &state) != 1) {
-        fclose(fp);
-        return true;  // Assume kernel thread if state cannot be read
+    bool ok = procfs_read_fd_single(fd, buf) && buf->len > 0;
+    if (ok && keep_open) {
+        *fd_out = fd;
+    } else {
+        close(fd);
     }
-    fclose(fp);
-
-    // Kernel threads typically have state 'K'
-    return (state == 'K');
+    return ok;
 }
 
-// Process-specific statistics from /proc/[pid]/stat
-static bool read_process_stat(pid_t pid, process_info_t *process) {
-    char stat_path[64];
-    snprintf(stat_path, sizeof(stat_path), "/proc/%d/stat", pid);
+// Parse process statistics from /proc/[pid]/stat content
+static bool parse_process_stat(pid_t pid, const procfs_buf_t *buf,
+                               process_info_t *process, bool *kernel_thread) {
+    // The name may itself contain spaces or parentheses, so it spans from
+    // the first '(' to the last ')'
+    const char *open_paren = memchr(buf->data, '(', buf->len);
+    const char *close_paren = buf->data + buf->len;
+    while (close_paren > buf->data && *close_paren != ')') close_paren--;
+    if (!open_paren || close_paren <= open_paren) return false;
 
-    FILE *fp = fopen(stat_path, "r");
-    if (!fp) return false;
+    size_t len = (size_t)(close_paren - open_paren - 1);
+    if (len >= MAX_PROC_NAME) len = MAX_PROC_NAME - 1;
+    memcpy(process->name, open_paren + 1, len);
+    process->name[len] = '\0';
 
-    char name[MAX_PROC_NAME];
-    char state;
-    unsigned long utime, stime;
-    long rss;
-    unsigned long long starttime;
+    procfs_cursor_t cur = { close_paren + 1, buf->data + buf->len };
+    uint64_t flags, utime, stime, starttime, rss;
 
-    if (fscanf(fp, "%*d %s %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
-                  "%lu %lu %*d %*d %*d %*d %*u %llu",
-             name, &state, &utime, &stime, &starttime) != 5) {
-        fclose(fp);
+    // Fields are numbered from 1 (pid); skip_fields(0) lands on field 3 (state)
+    if (!procfs_skip_fields(&cur, 0) ||
+        !procfs_skip_fields(&cur, 6) ||        // -> 9 flags
+        !procfs_parse_u64(&cur, &flags) ||
+        !procfs_skip_fields(&cur, 4) ||        // -> 14 utime
+        !procfs_parse_u64(&cur, &utime) ||
+        !procfs_parse_u64(&cur, &stime) ||    // 15 stime
+        !procfs_skip_fields(&cur, 6) ||        // -> 22 starttime
+        !procfs_parse_u64(&cur, &starttime) ||
+        !procfs_skip_fields(&cur, 1) ||        // -> 24 rss (pages)
+        !procfs_parse_u64(&cur, &rss)) {
         log_error("Failed to parse /proc/%d/stat", pid);
         return false;
     }
 
-    if (fscanf(fp, "%ld", &rss) != 1) {
-        fclose(fp);
-        return false;
-    }
-    fclose(fp);
-
-    // Remove parentheses from process name
-    size_t len = strlen(name);
-    if (len > 1) {
-        memmove(name, name+1, len-2);
-        name[len-2] = '\0';
-    }
+    *kernel_thread = (flags & PF_KTHREAD) != 0;
 
-    strncpy(process->name, name, MAX_PROC_NAME);
     process->pid = pid;
+    process->starttime = starttime;
     process->last_utime = utime;
     process->last_stime = stime;
-    process->mem_used = rss * (sysconf(_SC_PAGE_SIZE) / 1024);
+    process->mem_used = rss * page_size_kb;
     process->cpu_usage = 0.0;
     process->mem_usage = 0.0;
+    process->sockets = 0;
+    process->net_rx_rate = 0.0;
+    process->net_tx_rate = 0.0;
+    process->io_read_rate = 0.0;
+    process->io_write_rate = 0.0;
+    process->syscr_rate = 0.0;
+    process->syscw_rate = 0.0;
+    process->io_available = true;
+    process->mem_pss = 0;
+    process->mem_uss = 0;
+    process->mem_swap = 0;
+    process->mem_detail = MEM_DETAIL_NONE;
+
+    return true;
+}
+
+// Append a PID to the scan list, handing it the table's cached descriptor
+static bool add_scan_item(pid_t pid, proc_entry_t *cached) {
+    if (scan.item_count == scan.item_capacity) {
+        size_t capacity = scan.item_capacity * 2;
+        scan_item_t *items = realloc(scan.items, capacity * sizeof(scan_item_t));
+        if (!items) {
+            log_error("Memory allocation failed");
+            return false;
+        }
+        scan.items = items;
+        scan.item_capacity = capacity;
+    }
+
+    scan_item_t *item = &scan.items[scan.item_count++];
+    item->pid = pid;
+    // Ownership moves to the worker that scans this PID
+    item->cached_fd = cached ? process_table_take_fd(&table, cached) : -1;
+    return true;
+}
+
+// List numeric /proc entries, handing each PID its cached descriptor
+static bool list_pids(void) {
+    if (lseek(scan.dir_fd, 0, SEEK_SET) == -1) {
+        log_error("Failed to rewind /proc");
+        return false;
+    }
+
+    scan.item_count = 0;
+    int calls = 0;
+
+    for (;;) {
+        ssize_t n = getdents64(scan.dir_fd, scan.dirents, scan.dirents_size);
+        if (n < 0) {
+            log_error("Failed to list /proc");
+            return false;
+        }
+        if (n == 0) break;
+        calls++;
+
+        for (ssize_t off = 0; off < n; ) {
+            const struct dirent64 *d = (const struct dirent64 *)(scan.dirents + off);
+            off += d->d_reclen;
+
+            if (!isdigit((unsigned char)d->d_name[0])) continue;
+
+            pid_t pid = atoi(d->d_name);
+            if (pid <= 1) continue;
+
+            proc_entry_t *cached = fd_cache_enabled ? process_table_find_pid(&table, pid) : NULL;
+            if (!add_scan_item(pid, cached)) return false;
+        }
+    }
+
+    // Grow the buffer so the next scan needs a single getdents64 call
+    if (calls > 2) {
+        char *bigger = realloc(scan.dirents, scan.dirents_size * 2);
+        if (bigger) {
+            scan.dirents = bigger;
+            scan.dirents_size *= 2;
+        }
+    }
+    return true;
+}
+
+// List the live table entries instead of walking /proc
+static bool list_table_pids(void) {
+    scan.item_count = 0;
+
+    for (size_t i = 0; i < table.table.capacity; i++) {
+        proc_entry_t *e = hash_table_slot(&table.table, i);
+        if (e->slot.state != HASH_SLOT_LIVE) continue;
+        if (!add_scan_item(e->pid, e)) return false;
+    }
+    return true;
+}
+
+// Record the final sample of an exiting process
+static void record_exit(const process_info_t *info, const proc_entry_t *prev) {
+    if (events.exited_count == EXITED_MAX) return;
+
+    if (events.exited_count == events.exited_capacity) {
+        int capacity = events.exited_capacity ? events.exited_capacity * 2 : 64;
+        exited_process_t *exited = realloc(events.exited, capacity * sizeof(exited_process_t));
+        if (!exited) return;
+        events.exited = exited;
+        events.exited_capacity = capacity;
+    }
+
+    exited_process_t *x = &events.exited[events.exited_count++];
+    x->info = *info;
+    x->jiffies = (info->last_utime - prev->utime) + (info->last_stime - prev->stime);
+}
+
+// Remember the first sample of a new process, in case it is gone before
+// its exit event can be read
+static void record_birth(proc_entry_t *e, const process_info_t *info) {
+    if (e->born > 0 && events.born[e->born - 1].pid == info->pid) {
+        events.born[e->born - 1] = *info;       // exec: new name
+        return;
+    }
+    if (events.born_count == EXITED_MAX) return;
+
+    if (events.born_count == events.born_capacity) {
+        int capacity = events.born_capacity ? events.born_capacity * 2 : 64;
+        process_info_t *born = realloc(events.born, capacity * sizeof(process_info_t));
+        if (!born) return;
+        events.born = born;
+        events.born_capacity = capacity;
+    }
+
+    events.born[events.born_count++] = *info;
+    e->born = events.born_count;
+}
+
+// Apply one connector event to the table. Runs on the collector thread,
+// between ticks or at the start of one.
+static void handle_proc_event(proc_event_kind_t kind, pid_t pid, void *ctx) {
+    (void)ctx;
+    procfs_buf_t *buf = &scan.slabs[0].buf;
+    proc_entry_t *e = process_table_find_pid(&table, pid);
+
+    // Names of sampled processes are refreshed on the next tick anyway
+    if (kind == PROC_EV_EXEC && e && e->born == 0) return;
 
+    process_info_t info;
+    bool kernel_thread;
+    int fd;
+    bool ok = read_stat_file(pid, -1, false, &fd, buf) &&
+              parse_process_stat(pid, buf, &info, &kernel_thread);
+
+    if (kind == PROC_EV_EXIT) {
+        static const proc_entry_t unborn = { 0 };
+
+        if (ok) {
+            // Still readable: the event arrived before the parent reaped it
+            if (!kernel_thread) {
+                bool same = e && e->starttime == info.starttime;
+                record_exit(&info, same ? e : &unborn);
+            }
+        } else if (e && e->born > 0 && events.born[e->born - 1].pid == pid) {
+            // Already reaped; report what was seen at fork or exec
+            record_exit(&events.born[e->born - 1], e);
+        }
+        if (e) process_table_remove(&table, e);
+        return;
+    }
+
+    if (!ok) return;
+
+    // A stale entry means an exit event was missed and the PID reused
+    if (e && e->starttime != info.starttime) {
+        process_table_remove(&table, e);
+    }
+
+    // New entries start from zero CPU time, so the next tick charges them
+    // with everything they used since they were born
+    bool inserted;
+    e = process_table_upsert(&table, pid, info.starttime, &inserted);
+    if (e && !kernel_thread) record_birth(e, &info);
+}
+
+bool process_collector_handle_events(void) {
+    if (!events.enabled) return true;
+
+    if (!proc_events_drain(handle_proc_event, NULL)) {
+        if (!events.resync) log_warning("Process events were lost, rescanning /proc");
+        events.resync = true;
+    }
+    return true;
+}
+
+int process_collector_event_fd(void) {
+    return events.enabled ? proc_events_fd() : -1;
+}
+
+// Worker body: read and parse one PID into the worker's own slab
+static void scan_pid(void *ctx, int worker, size_t index) {
+    (void)ctx;
+    scan_slab_t *slab = &scan.slabs[worker];
+    const scan_item_t *item = &scan.items[index];
+
+    if (slab->count == slab->capacity) {
+        size_t capacity = slab->capacity ? slab->capacity * 2 : SCAN_ITEMS_INITIAL;
+        scan_result_t *results = realloc(slab->results, capacity * sizeof(scan_result_t));
+        if (!results) {
+            if (item->cached_fd != -1) close(item->cached_fd);
+            return;
+        }
+        slab->results = results;
+        slab->capacity = capacity;
+    }
+
+    // A cached descriptor is always kept; a new one only while budget remains
+    bool keep_open = item->cached_fd != -1 ||
+                     (fd_cache_enabled &&
+                      atomic_fetch_sub_explicit(&scan.fd_budget, 1, memory_order_relaxed) > 0);
+
+    scan_result_t *result = &slab->results[slab->count];
+    if (!read_stat_file(item->pid, item->cached_fd, keep_open, &result->fd, &slab->buf)) {
+        return;
+    }
+    if (!parse_process_stat(item->pid, &slab->buf, &result->info, &result->kernel_thread)) {
+        if (result->fd != -1) close(result->fd);
+        return;
+    }
+
+    // A cheap stat tells the socket index whether the descriptors changed
+    result->fd_count = sockets_enabled && !result->kernel_thread ?
+                       sock_index_fd_count(item->pid) : -1;
+    slab->count++;
+}
+
+// Queue a /proc/[pid]/io read for metrics->processes[index]
+static void queue_io_read(int index) {
+    if (io_scan.count == io_scan.capacity) {
+        size_t capacity = io_scan.capacity ? io_scan.capacity * 2 : SCAN_ITEMS_INITIAL;
+        io_item_t *items = realloc(io_scan.items, capacity * sizeof(io_item_t));
+        if (!items) return;
+        io_scan.items = items;
+        io_scan.capacity = capacity;
+    }
+    io_scan.items[io_scan.count++] = (io_item_t){ .index = index };
+}
+
+// Parse the syscr, syscw, read_bytes and write_bytes lines of /proc/[pid]/io
+static bool parse_io(const procfs_buf_t *buf, proc_io_t *io) {
+    static const struct {
+        const char *key;
+        size_t len;
+        size_t offset;
+    } fields[] = {
+        { "syscr:", 6, offsetof(proc_io_t, syscr) },
+        { "syscw:", 6, offsetof(proc_io_t, syscw) },
+        { "read_bytes:", 11, offsetof(proc_io_t, read_bytes) },
+        { "write_bytes:", 12, offsetof(proc_io_t, write_bytes) }
+    };
+    const size_t num_fields = sizeof(fields) / sizeof(fields[0]);
+
+    procfs_cursor_t cur = procfs_cursor(buf);
+    procfs_cursor_t line;
+    size_t found = 0;
+
+    while (found < num_fields && procfs_next_line(&cur, &line)) {
+        for (size_t f = 0; f < num_fields; f++) {
+            if (procfs_consume(&line, fields[f].key, fields[f].len)) {
+                if (!procfs_parse_u64(&line, (uint64_t *)((char *)io + fields[f].offset))) {
+                    return false;
+                }
+                found++;
+                break;
+            }
+        }
+    }
+    return found == num_fields;
+}
+
+// Worker body: read one queued /proc/[pid]/io
+static void read_io(void *ctx, int worker, size_t index) {
+    const process_metrics_t *metrics = ctx;
+    io_item_t *item = &io_scan.items[index];
+    procfs_buf_t *buf = &scan.slabs[worker].buf;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/io", metrics->processes[item->index].pid);
+
+    // Access is checked on read, not on open
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return;
+    if (procfs_read_fd_single(fd, buf)) {
+        item->ok = parse_io(buf, &item->io);
+    } else {
+        item->denied = errno == EACCES || errno == EPERM;
+    }
+    close(fd);
+}
+
+// Difference of a counter that may have been reset
+static uint64_t counter_delta(uint64_t now, uint64_t prev) {
+    return now >= prev ? now - prev : 0;
+}
+
+// Turn the queued reads into rates against each process's last sample
+static void apply_io_reads(process_metrics_t *metrics, uint64_t now) {
+    for (size_t i = 0; i < io_scan.count; i++) {
+        const io_item_t *item = &io_scan.items[i];
+        process_info_t *process = &metrics->processes[item->index];
+
+        proc_entry_t *e = process_table_find_pid(&table, process->pid);
+        if (!e || e->starttime != process->starttime) continue;
+
+        if (item->denied) {
+            e->io_denied = true;
+            process->io_available = false;
+            continue;
+        }
+        if (!item->ok) continue;
+
+        if (e->io_ns != 0 && now > e->io_ns) {
+            double seconds = (double)(now - e->io_ns) / NSEC_PER_SEC;
+            process->io_read_rate =
+                counter_delta(item->io.read_bytes, e->io.read_bytes) / 1024.0 / seconds;
+            process->io_write_rate =
+                counter_delta(item->io.write_bytes, e->io.write_bytes) / 1024.0 / seconds;
+            process->syscr_rate = counter_delta(item->io.syscr, e->io.syscr) / seconds;
+            process->syscw_rate = counter_delta(item->io.syscw, e->io.syscw) / seconds;
+        }
+        e->io = item->io;
+        e->io_ns = now;
+    }
+    io_scan.count = 0;
+}
+
+void process_collector_set_visible(const process_info_t *const *rows, int count) {
+    if (count < 0) count = 0;
+    if (count > PROCESS_VISIBLE_MAX) count = PROCESS_VISIBLE_MAX;
+
+    pthread_mutex_lock(&smaps_scan.lock);
+    for (int i = 0; i < count; i++) {
+        smaps_scan.rows[i] = (smaps_item_t){ .pid = rows[i]->pid,
+                                             .starttime = rows[i]->starttime };
+    }
+    smaps_scan.row_count = count;
+    pthread_mutex_unlock(&smaps_scan.lock);
+}
+
+// Queue smaps_rollup reads for the visible processes whose figures expired
+static void queue_smaps_reads(uint64_t now) {
+    pthread_mutex_lock(&smaps_scan.lock);
+    memcpy(smaps_scan.items, smaps_scan.rows, smaps_scan.row_count * sizeof(smaps_item_t));
+    size_t count = (size_t)smaps_scan.row_count;
+    pthread_mutex_unlock(&smaps_scan.lock);
+
+    smaps_scan.count = 0;
+    for (size_t i = 0; i < count; i++) {
+        const smaps_item_t *row = &smaps_scan.items[i];
+        proc_entry_t *e = process_table_find_pid(&table, row->pid);
+        if (!e || e->starttime != row->starttime || e->smaps_denied) continue;
+        if (e->smaps_ns != 0 && now - e->smaps_ns < smaps_scan.ttl_ns) continue;
+        smaps_scan.items[smaps_scan.count++] = *row;
+    }
+}
+
+// Parse the Pss, Private_Clean, Private_Dirty and Swap lines of smaps_rollup
+static bool parse_smaps(const procfs_buf_t *buf, proc_smaps_t *smaps) {
+    static const struct {
+        const char *key;
+        size_t len;
+    } fields[] = {
+        { "Pss:", 4 },
+        { "Private_Clean:", 14 },
+        { "Private_Dirty:", 14 },
+        { "Swap:", 5 }
+    };
+    const size_t num_fields = sizeof(fields) / sizeof(fields[0]);
+    uint64_t values[sizeof(fields) / sizeof(fields[0])];
+
+    procfs_cursor_t cur = procfs_cursor(buf);
+    procfs_cursor_t line;
+    size_t found = 0;
+
+    while (found < num_fields && procfs_next_line(&cur, &line)) {
+        for (size_t f = 0; f < num_fields; f++) {
+            if (procfs_consume(&line, fields[f].key, fields[f].len)) {
+                if (!procfs_parse_u64(&line, &values[f])) return false;
+                found++;
+                break;
+            }
+        }
+    }
+    if (found != num_fields) return false;
+
+    smaps->pss = values[0];
+    smaps->uss = values[1] + values[2];
+    smaps->swap = values[3];
     return true;
 }
 
-static int compare_processes(const void *a, const void *b) {
+// Worker body: read one queued /proc/[pid]/smaps_rollup
+static void read_smaps(void *ctx, int worker, size_t index) {
+    (void)ctx;
+    smaps_item_t *item = &smaps_scan.items[index];
+    procfs_buf_t *buf = &scan.slabs[worker].buf;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", item->pid);
+
+    // Access to another process's mappings is checked on open
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        item->denied = errno == EACCES || errno == EPERM;
+        return;
+    }
+    // Generated in one piece; a second read would walk the mappings again
+    if (procfs_read_fd_single(fd, buf)) {
+        item->ok = parse_smaps(buf, &item->smaps);
+    } else {
+        item->denied = errno == EACCES || errno == EPERM;
+    }
+    close(fd);
+}
+
+// Store the reads in the table, where the merge picks them up
+static void apply_smaps_reads(uint64_t now) {
+    for (size_t i = 0; i < smaps_scan.count; i++) {
+        const smaps_item_t *item = &smaps_scan.items[i];
+        proc_entry_t *e = process_table_find_pid(&table, item->pid);
+        if (!e || e->starttime != item->starttime) continue;
+
+        if (item->denied) {
+            e->smaps_denied = true;
+        } else if (item->ok) {
+            e->smaps = item->smaps;
+            e->smaps_ns = now;
+        }
+    }
+    smaps_scan.count = 0;
+}
+
+int process_compare_io(const void *a, const void *b) {
+    const process_info_t *pa = a;
+    const process_info_t *pb = b;
+    double io_a = pa->io_read_rate + pa->io_write_rate;
+    double io_b = pb->io_read_rate + pb->io_write_rate;
+
+    // First by disk I/O rate descending
+    if (io_b > io_a) return 1;
+    if (io_b < io_a) return -1;
+
+    // Then by CPU% descending
+    if (pb->cpu_usage > pa->cpu_usage) return 1;
+    if (pb->cpu_usage < pa->cpu_usage) return -1;
+
+    return (pa->pid > pb->pid) ? 1 : -1;
+}
+
+process_compare_fn process_comparator(process_sort_t sort) {
+    return sort == PROCESS_SORT_IO ? process_compare_io : process_compare;
+}
+
+void process_collector_set_sort(process_sort_t sort) {
+    atomic_store_explicit(&io_scan.requested_sort, (int)sort, memory_order_relaxed);
+}
+
+int process_compare(const void *a, const void *b) {
     const process_info_t *pa = a;
     const process_info_t *pb = b;
 
@@ -104,64 +718,339 @@ static int compare_processes(const void *a, const void *b) {
     return (pa->pid > pb->pid) ? 1 : -1;
 }
 
-bool process_collector_collect(process_metrics_t *metrics) {
-    // Get total CPU jiffies
-    FILE *stat_fp = fopen("/proc/stat", "r");
-    if (!stat_fp) return false;
+// Sort key of one entry under the given order
+static rank_key_t make_key(const process_info_t *p, int index, process_sort_t sort) {
+    if (sort == PROCESS_SORT_IO) {
+        return (rank_key_t){ p->io_read_rate + p->io_write_rate, p->cpu_usage, p->pid, index };
+    }
+    return (rank_key_t){ p->cpu_usage, p->mem_usage, p->pid, index };
+}
+
+// Ordering of two keys, matching process_comparator()
+static int compare_keys(const rank_key_t *a, const rank_key_t *b) {
+    if (b->primary != a->primary) return b->primary > a->primary ? 1 : -1;
+    if (b->secondary != a->secondary) return b->secondary > a->secondary ? 1 : -1;
+    return a->pid > b->pid ? 1 : -1;
+}
+
+static int compare_keys_qsort(const void *a, const void *b) {
+    return compare_keys(a, b);
+}
+
+// Restore the heap property below slot i; the root ranks last
+static void heap_sift_down(rank_key_t *heap, int n, int i) {
+    for (;;) {
+        int worst = i;
+        int l = 2 * i + 1, r = l + 1;
+        if (l < n && compare_keys(&heap[l], &heap[worst]) > 0) worst = l;
+        if (r < n && compare_keys(&heap[r], &heap[worst]) > 0) worst = r;
+        if (worst == i) return;
+
+        rank_key_t tmp = heap[i];
+        heap[i] = heap[worst];
+        heap[worst] = tmp;
+        i = worst;
+    }
+}
+
+// Move last tick's leaders to the front, in their old order, so the heap
+// starts out holding (nearly) this tick's answer and later entries are
+// mostly rejected by a single comparison against the root
+static void move_seeds_to_front(process_metrics_t *metrics) {
+    int front = 0;
 
-    char line[256];
-    unsigned long long total_jiffies = 0;
-    unsigned long long work_jiffies = 0;
+    for (int r = 0; r < PROCESS_TOP_K; r++) {
+        int from = rank.seeds[r];
+        if (from < 0) continue;
 
-    while (fgets(line, sizeof(line), stat_fp)) {
-        if (strncmp(line, "cpu ", 4) == 0) {
-            unsigned long user, nice, system, idle, iowait, irq, softirq;
-            sscanf(line + 5, "%lu %lu %lu %lu %lu %lu %lu",
-                  &user, &nice, &system, &idle, &iowait, &irq, &softirq);
-            work_jiffies = user + nice + system + irq + softirq;
-            total_jiffies = work_jiffies + idle + iowait;
-            break;
+        if (from != front) {
+            process_info_t tmp = metrics->processes[front];
+            metrics->processes[front] = metrics->processes[from];
+            metrics->processes[from] = tmp;
+
+            // A later seed sitting at front has just moved to from
+            for (int s = r + 1; s < PROCESS_TOP_K; s++) {
+                if (rank.seeds[s] == front) {
+                    rank.seeds[s] = from;
+                    break;
+                }
+            }
         }
+        front++;
     }
-    fclose(stat_fp);
+}
 
-    // Scan /proc for processes
-    DIR *dir = opendir("/proc");
-    if (!dir) return false;
+// Put the PROCESS_TOP_K highest ranked entries, sorted, at the front of
+// metrics->processes; the rest stay unordered behind them. The UI sorts
+// the tail itself if the user scrolls into it.
+static void select_top_processes(process_metrics_t *metrics, process_sort_t sort) {
+    int n = metrics->count;
+    int k = n < PROCESS_TOP_K ? n : PROCESS_TOP_K;
 
-    metrics->count = 0;
-    struct dirent *entry;
+    metrics->generation = ++rank.generation;
+    metrics->sorted = k;
+    metrics->sort = sort;
+    if (k == 0) return;
 
-    while ((entry = readdir(dir)) != NULL && metrics->count < MAX_PROCESSES) {
-        if (!isdigit(entry->d_name[0])) continue;
+    if ((size_t)n > rank.capacity) {
+        size_t capacity = rank.capacity ? rank.capacity : PROCESS_METRICS_INITIAL;
+        while (capacity < (size_t)n) capacity *= 2;
 
-        pid_t pid = atoi(entry->d_name);
-        if (pid <= 1 || is_kernel_thread(pid)) continue;
+        rank_key_t *keys = realloc(rank.keys, capacity * sizeof(rank_key_t));
+        if (!keys) {
+            log_error("Memory allocation failed");
+            qsort(metrics->processes, n, sizeof(process_info_t), process_comparator(sort));
+            metrics->sorted = n;
+            return;
+        }
+        rank.keys = keys;
+        rank.capacity = capacity;
+    }
+
+    move_seeds_to_front(metrics);
+
+    for (int i = 0; i < n; i++) {
+        const process_info_t *p = &metrics->processes[i];
+        rank.keys[i] = make_key(p, i, sort);
+    }
 
-        if (read_process_stat(pid, &metrics->processes[metrics->count])) {
-            metrics->count++;
+    // Bounded heap of the best k seen so far
+    for (int i = 0; i < k; i++) {
+        rank.heap[i] = rank.keys[i];
+    }
+    for (int i = k / 2 - 1; i >= 0; i--) {
+        heap_sift_down(rank.heap, k, i);
+    }
+    for (int i = k; i < n; i++) {
+        if (compare_keys(&rank.keys[i], &rank.heap[0]) < 0) {
+            rank.heap[0] = rank.keys[i];
+            heap_sift_down(rank.heap, k, 0);
         }
     }
-    closedir(dir);
 
-    // Calculate CPU usage if we have previous data
+    qsort(rank.heap, k, sizeof(rank_key_t), compare_keys_qsort);
+
+    // Lift the winners out, then backfill the holes they leave past k
+    // with the losers found in the first k slots
+    for (int i = 0; i < k; i++) {
+        rank.top[i] = metrics->processes[rank.heap[i].index];
+        rank.keys[rank.heap[i].index].index = -1;
+    }
+
+    int loser = 0;
+    for (int i = 0; i < k; i++) {
+        int hole = rank.heap[i].index;
+        if (hole < k) continue;
+
+        while (rank.keys[loser].index == -1) loser++;
+        metrics->processes[hole] = metrics->processes[loser++];
+    }
+
+    for (int i = 0; i < k; i++) {
+        metrics->processes[i] = rank.top[i];
+
+        proc_entry_t *e = process_table_find_pid(&table, rank.top[i].pid);
+        if (e && e->starttime == rank.top[i].starttime) {
+            e->rank = i + 1;
+        }
+    }
+}
+
+bool process_metrics_reserve(process_metrics_t *metrics, int n) {
+    if (n <= metrics->capacity) return true;
+
+    // Geometric growth so a steady process count never reallocates
+    int capacity = metrics->capacity > 0 ? metrics->capacity : PROCESS_METRICS_INITIAL;
+    while (capacity < n) capacity *= 2;
+
+    process_info_t *processes = realloc(metrics->processes, capacity * sizeof(process_info_t));
+    if (!processes) {
+        log_error("Memory allocation failed");
+        return false;
+    }
+    metrics->processes = processes;
+    metrics->capacity = capacity;
+    return true;
+}
+
+bool process_metrics_copy(process_metrics_t *dst, const process_metrics_t *src) {
+    if (!process_metrics_reserve(dst, src->count)) return false;
+
+    if (src->count > 0) {
+        memcpy(dst->processes, src->processes, src->count * sizeof(process_info_t));
+    }
+    dst->count = src->count;
+    dst->sorted = src->sorted;
+    dst->sort = src->sort;
+    dst->generation = src->generation;
+    return true;
+}
+
+void process_metrics_free(process_metrics_t *metrics) {
+    free(metrics->processes);
+    metrics->processes = NULL;
+    metrics->count = 0;
+    metrics->capacity = 0;
+    metrics->sorted = 0;
+}
+
+bool process_collector_collect(process_metrics_t *metrics) {
+    // Get total CPU jiffies from the shared /proc/stat snapshot
+    const system_stat_t *stat = system_stat_get();
+    if (!stat) return false;
+
+    const cpu_times_t *cpu = &stat->total;
+    unsigned long long work_jiffies = cpu->user + cpu->nice + cpu->system + cpu->irq + cpu->softirq;
+    unsigned long long total_jiffies = work_jiffies + cpu->idle + cpu->iowait;
+
+    // CPU usage is only meaningful once we have a previous total
+    unsigned long long total_diff = 0;
     if (prev_total_jiffies > 0 && total_jiffies > prev_total_jiffies) {
-        unsigned long long total_diff = total_jiffies - prev_total_jiffies;
+        total_diff = total_jiffies - prev_total_jiffies;
+    }
+
+    // Find the processes to read: follow the connector when possible,
+    // otherwise (and after lost events) walk /proc
+    process_collector_handle_events();
+    if (events.enabled && !events.resync) {
+        if (!list_table_pids()) return false;
+    } else {
+        if (!list_pids()) return false;
+        events.resync = false;
+    }
+
+    long budget = fd_cache_enabled ? (long)fd_cache_limit - (long)table.cached_fds : 0;
+    atomic_store_explicit(&scan.fd_budget, budget, memory_order_relaxed);
+    for (int w = 0; w < scan.pool.num_workers; w++) {
+        scan.slabs[w].count = 0;
+    }
+
+    // Read every PID, split across the workers
+    thread_pool_run(&scan.pool, scan.item_count, scan_pid, NULL);
+
+    // Sorting by I/O needs every process's counters
+    process_sort_t sort = (process_sort_t)atomic_load_explicit(&io_scan.requested_sort,
+                                                               memory_order_relaxed);
+    bool io_sweep = sort == PROCESS_SORT_IO;
+    uint64_t now = monotonic_ns();
+
+    // Refresh the memory breakdown of the rows on screen before the merge
+    // copies it out of the table
+    queue_smaps_reads(now);
+    if (smaps_scan.count > 0) {
+        thread_pool_run(&scan.pool, smaps_scan.count, read_smaps, NULL);
+        apply_smaps_reads(now);
+    }
+
+    // Merge the worker slabs into the table; only this thread touches it
+    metrics->count = 0;
+    process_table_begin_tick(&table);
+    if (sockets_enabled) sock_index_begin_tick();
+    for (int r = 0; r < PROCESS_TOP_K; r++) {
+        rank.seeds[r] = -1;
+    }
+
+    for (int w = 0; w < scan.pool.num_workers; w++) {
+        scan_slab_t *slab = &scan.slabs[w];
+
+        for (size_t r = 0; r < slab->count; r++) {
+            scan_result_t *result = &slab->results[r];
+
+            // Match against the previous sample of the same process; a reused
+            // PID has a different starttime and so starts a new entry
+            bool inserted;
+            proc_entry_t *prev = process_table_upsert(&table, result->info.pid,
+                                                      result->info.starttime, &inserted);
+            if (!prev) {
+                if (result->fd != -1) close(result->fd);
+                continue;
+            }
+            process_table_attach_fd(&table, prev, result->fd);
+            prev->born = 0;
+
+            // Kernel threads stay in the table so their descriptor is reused,
+            // but are not reported
+            if (result->kernel_thread) continue;
+
+            process_info_t *process = &result->info;
+            bool ran = process->last_utime + process->last_stime != prev->utime + prev->stime;
+            if (sockets_enabled) {
+                sock_index_touch(process->pid, process->starttime, result->fd_count);
+            }
+            if (!inserted && total_diff > 0) {
+                unsigned long long utime_diff = process->last_utime - prev->utime;
+                unsigned long long stime_diff = process->last_stime - prev->stime;
+                unsigned long long process_diff = utime_diff + stime_diff;
+
+                process->cpu_usage = (process_diff * 100.0) / total_diff;
+            }
+            prev->utime = process->last_utime;
+            prev->stime = process->last_stime;
+
+            if (prev->smaps_ns != 0) {
+                process->mem_pss = prev->smaps.pss;
+                process->mem_uss = prev->smaps.uss;
+                process->mem_swap = prev->smaps.swap;
+                process->mem_detail = now - prev->smaps_ns <= smaps_scan.ttl_ns ?
+                                      MEM_DETAIL_FRESH : MEM_DETAIL_STALE;
+            }
+
+            if (!process_metrics_reserve(metrics, metrics->count + 1)) continue;
+            metrics->processes[metrics->count++] = *process;
+
+            if (prev->io_denied) {
+                metrics->processes[metrics->count - 1].io_available = false;
+            } else if (io_sweep || ran || inserted || prev->rank > 0) {
+                queue_io_read(metrics->count - 1);
+            } else if (prev->io_ns != 0) {
+                prev->io_ns = now;      // Idle: the counters cannot have moved
+            }
+
+            // Remember where last tick's leaders landed to seed the selection
+            if (prev->rank > 0) {
+                rank.seeds[prev->rank - 1] = metrics->count - 1;
+                prev->rank = 0;
+            }
+        }
+    }
+
+    // Retire processes that were not seen this tick
+    process_table_end_tick(&table);
+
+    // Read /proc/[pid]/io for the processes queued above
+    if (io_scan.count > 0) {
+        thread_pool_run(&scan.pool, io_scan.count, read_io, metrics);
+        apply_io_reads(metrics, now);
+    }
+
+    // Rescan changed descriptor tables, then attach socket activity
+    if (sockets_enabled) {
+        sock_index_end_tick(socket_budget_ns);
 
         for (int i = 0; i < metrics->count; i++) {
-            for (int j = 0; j < prev_process_count; j++) {
-                if (metrics->processes[i].pid == prev_processes[j].pid) {
-                    unsigned long long utime_diff = metrics->processes[i].last_utime - prev_processes[j].last_utime;
-                    unsigned long long stime_diff = metrics->processes[i].last_stime - prev_processes[j].last_stime;
-                    unsigned long long process_diff = utime_diff + stime_diff;
-                    
-                    metrics->processes[i].cpu_usage = (process_diff * 100.0) / total_diff;
-                    break;
-                }
+            process_info_t *process = &metrics->processes[i];
+            sock_usage_t usage;
+            if (sock_index_usage(process->pid, process->starttime, &usage)) {
+                process->sockets = usage.sockets;
+                process->net_rx_rate = usage.rx_rate;
+                process->net_tx_rate = usage.tx_rate;
             }
         }
     }
 
+    // Processes that exited since the last tick, including ones that
+    // never lived long enough to be sampled
+    for (int i = 0; i < events.exited_count; i++) {
+        process_info_t *process = &events.exited[i].info;
+        process->cpu_usage = total_diff > 0 ?
+                             (events.exited[i].jiffies * 100.0) / total_diff : 0.0;
+
+        if (!process_metrics_reserve(metrics, metrics->count + 1)) break;
+        metrics->processes[metrics->count++] = *process;
+    }
+    events.exited_count = 0;
+    events.born_count = 0;
+
     // Calculate memory usage
     long total_memory = sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGE_SIZE) / 1024;
     if (total_memory > 0) {
@@ -170,12 +1059,10 @@ bool process_collector_collect(process_metrics_t *metrics) {
         }
     }
 
-    // Sort by CPU usage
-    qsort(metrics->processes, metrics->count, sizeof(process_info_t), compare_processes);
+    // Order only the entries the panel is likely to show
+    select_top_processes(metrics, sort);
 
     // Save current state for next iteration
-    memcpy(prev_processes, metrics->processes, metrics->count * sizeof(process_info_t));
-    prev_process_count = metrics->count;
     prev_total_jiffies = total_jiffies;
     prev_work_jiffies = work_jiffies;
 
@@ -187,10 +1074,137 @@ bool process_collector_init(void)
 {
     prev_total_jiffies = 0;
     prev_work_jiffies = 0;
-    return true;
+
+    page_size_kb = sysconf(_SC_PAGE_SIZE) / 1024;
+
+    fd_cache_enabled = config_get_bool("process.fd_cache", false);
+    if (fd_cache_enabled) {
+        // Raise the soft descriptor limit as far as allowed and leave
+        // headroom for everything else sysmon opens
+        struct rlimit lim;
+        if (getrlimit(RLIMIT_NOFILE, &lim) == 0) {
+            if (lim.rlim_cur < lim.rlim_max) {
+                lim.rlim_cur = lim.rlim_max;
+                setrlimit(RLIMIT_NOFILE, &lim);
+                getrlimit(RLIMIT_NOFILE, &lim);
+            }
+            fd_cache_limit = lim.rlim_cur > FD_CACHE_RESERVE ?
+                             (size_t)(lim.rlim_cur - FD_CACHE_RESERVE) : 0;
+        }
+        log_info("Process stat descriptor cache enabled, up to %zu descriptors",
+                 fd_cache_limit);
+    }
+
+    if (!process_table_init(&table, PROCESS_TABLE_INITIAL)) {
+        return false;
+    }
+
+    scan.dir_fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (scan.dir_fd == -1) {
+        log_error("Failed to open /proc");
+        return false;
+    }
+
+    scan.dirents_size = DIRENT_BUF_INITIAL;
+    scan.dirents = malloc(scan.dirents_size);
+    scan.item_capacity = SCAN_ITEMS_INITIAL;
+    scan.items = malloc(scan.item_capacity * sizeof(scan_item_t));
+    if (!scan.dirents || !scan.items) {
+        log_error("Memory allocation failed");
+        return false;
+    }
+
+    // Optional parallel scan; the collector thread itself is worker 0
+    long threads = config_get_long("process.scan_threads", 1);
+    if (threads < 1) threads = 1;
+    if (threads > THREAD_POOL_MAX) threads = THREAD_POOL_MAX;
+    if (!thread_pool_init(&scan.pool, (int)threads)) {
+        log_warning("Falling back to a serial process scan");
+        thread_pool_init(&scan.pool, 1);
+    }
+    for (int w = 0; w < scan.pool.num_workers; w++) {
+        if (!procfs_buf_init(&scan.slabs[w].buf, PROCFS_BUF_INITIAL)) {
+            log_error("Memory allocation failed");
+            return false;
+        }
+    }
+    if (scan.pool.num_workers > 1) {
+        log_info("Process scan uses %d worker threads", scan.pool.num_workers);
+    }
+
+    double smaps_ttl = config_get_double("process.smaps_ttl", 10.0);
+    smaps_scan.ttl_ns = smaps_ttl > 0 ? (uint64_t)(smaps_ttl * NSEC_PER_SEC) : 0;
+    smaps_scan.count = 0;
+
+    sockets_enabled = config_get_bool("process.sockets", true);
+    if (sockets_enabled) {
+        double budget_ms = config_get_double("process.socket_budget_ms", 5.0);
+        socket_budget_ns = budget_ms > 0 ? (uint64_t)(budget_ms * 1e6) : 0;
+        if (!sock_index_init(scan.dir_fd)) return false;
+    }
+
+    events.enabled = false;
+    events.exited_count = 0;
+    events.born_count = 0;
+    if (config_get_bool("process.events", false)) {
+        if (proc_events_open()) {
+            events.enabled = true;
+            events.resync = true;
+            log_info("Following process events from the proc connector");
+        } else {
+            log_warning("Process events unavailable, scanning /proc instead");
+        }
+    }
+
+    // Initialize with first reading so the first scheduled pass has deltas
+    process_metrics_t scratch = {0};
+    bool ok = process_collector_collect(&scratch);
+    process_metrics_free(&scratch);
+    return ok;
 }
 
 void process_collector_cleanup(void)
 {
-    // No resources to clean up
+    for (int w = 0; w < THREAD_POOL_MAX; w++) {
+        procfs_buf_free(&scan.slabs[w].buf);
+        free(scan.slabs[w].results);
+        scan.slabs[w].results = NULL;
+        scan.slabs[w].count = scan.slabs[w].capacity = 0;
+    }
+    if (scan.pool.num_workers > 0) thread_pool_destroy(&scan.pool);
+
+    free(scan.items);
+    free(scan.dirents);
+    scan.items = NULL;
+    scan.dirents = NULL;
+    scan.item_count = scan.item_capacity = 0;
+    if (scan.dir_fd != -1) close(scan.dir_fd);
+    scan.dir_fd = -1;
+
+    sock_index_cleanup();
+    sockets_enabled = false;
+
+    proc_events_close();
+    events.enabled = false;
+    free(events.exited);
+    events.exited = NULL;
+    events.exited_count = events.exited_capacity = 0;
+    free(events.born);
+    events.born = NULL;
+    events.born_count = events.born_capacity = 0;
+
+    free(rank.keys);
+    rank.keys = NULL;
+    rank.capacity = 0;
+
+    free(io_scan.items);
+    io_scan.items = NULL;
+    io_scan.count = io_scan.capacity = 0;
+
+    pthread_mutex_lock(&smaps_scan.lock);
+    smaps_scan.row_count = 0;
+    pthread_mutex_unlock(&smaps_scan.lock);
+    smaps_scan.count = 0;
+
+    process_table_free(&table);
 }
\ No newline at end of file
@@ -9,7 +9,9 @@
 
 #include "../include/sysmon.h"
 
-#define MAX_PROCESSES 1024  // Maximum number of processes to display
+#define PROCESS_METRICS_INITIAL 256  // Initial process array capacity
+#define PROCESS_TOP_K 32             // Entries put in display order every tick
+#define PROCESS_VISIBLE_MAX 128      // Rows whose smaps_rollup may be read per scan
 
 // Initialize process collector
 bool process_collector_init(void);
@@ -17,6 +19,41 @@ bool process_collector_init(void);
 // Collect process statistics
 bool process_collector_collect(process_metrics_t *metrics);
 
+// Make room for at least n processes, keeping existing entries
+bool process_metrics_reserve(process_metrics_t *metrics, int n);
+
+// Copy src into dst, growing dst's storage if needed
+bool process_metrics_copy(process_metrics_t *dst, const process_metrics_t *src);
+
+// Descriptor that becomes readable when process events are pending,
+// or -1 when the collector scans /proc
+int process_collector_event_fd(void);
+
+// Apply pending process events to the process table
+bool process_collector_handle_events(void);
+
+// Release the process array
+void process_metrics_free(process_metrics_t *metrics);
+
+// qsort comparator for process_info_t: CPU% desc, then MEM% desc, then PID asc
+int process_compare(const void *a, const void *b);
+
+// qsort comparator for process_info_t: disk I/O rate desc, then CPU% desc, then PID asc
+int process_compare_io(const void *a, const void *b);
+
+typedef int (*process_compare_fn)(const void *a, const void *b);
+
+// Comparator matching a process_sort_t
+process_compare_fn process_comparator(process_sort_t sort);
+
+// Order used from the next scan on; callable from any thread
+void process_collector_set_sort(process_sort_t sort);
+
+// Rows the panel shows; the next scans keep their PSS/USS/swap no older
+// than process.smaps_ttl. Pass 0 rows to stop reading. Callable from any
+// thread; entries past PROCESS_VISIBLE_MAX are ignored.
+void process_collector_set_visible(const process_info_t *const *rows, int count);
+
 // Clean up process collector resources
 void process_collector_cleanup(void);
 
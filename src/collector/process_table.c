@@ -0,0 +1,121 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * process_table.c - Persistent process table implementation
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include "process_table.h"
+
+// Only the PID is hashed, so every generation of a PID shares one probe
+// chain and process_table_find_pid() can locate it without a starttime
+static uint32_t hash_key(pid_t pid)
+{
+    uint64_t h = (uint64_t)(uint32_t)pid * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 29;
+    return (uint32_t)h;
+}
+
+typedef struct {
+    pid_t pid;
+    unsigned long long starttime;
+} proc_key_t;
+
+static bool key_equal(const void *entry, const void *key)
+{
+    const proc_entry_t *e = entry;
+    const proc_key_t *k = key;
+    return e->pid == k->pid && e->starttime == k->starttime;
+}
+
+static bool pid_equal(const void *entry, const void *key)
+{
+    return ((const proc_entry_t *)entry)->pid == *(const pid_t *)key;
+}
+
+bool process_table_init(process_table_t *table, size_t capacity)
+{
+    table->cached_fds = 0;
+    table->tick = 0;
+    return hash_table_init(&table->table, sizeof(proc_entry_t), capacity);
+}
+
+void process_table_free(process_table_t *table)
+{
+    for (size_t i = 0; i < table->table.capacity; i++) {
+        process_table_close_fd(table, hash_table_slot(&table->table, i));
+    }
+    hash_table_free(&table->table);
+}
+
+void process_table_begin_tick(process_table_t *table)
+{
+    table->tick++;
+}
+
+proc_entry_t *process_table_upsert(process_table_t *table, pid_t pid,
+                                   unsigned long long starttime, bool *inserted)
+{
+    proc_key_t key = { pid, starttime };
+    proc_entry_t *e = hash_table_upsert(&table->table, hash_key(pid), key_equal, &key, inserted);
+    if (!e) return NULL;
+
+    if (*inserted) {
+        e->pid = pid;
+        e->starttime = starttime;
+        e->stat_fd = -1;
+    }
+    e->seen = table->tick;
+    return e;
+}
+
+proc_entry_t *process_table_find_pid(process_table_t *table, pid_t pid)
+{
+    return hash_table_find(&table->table, hash_key(pid), pid_equal, &pid);
+}
+
+void process_table_attach_fd(process_table_t *table, proc_entry_t *entry, int fd)
+{
+    if (entry->stat_fd == fd) return;
+
+    process_table_close_fd(table, entry);
+    entry->stat_fd = fd;
+    if (fd != -1) table->cached_fds++;
+}
+
+int process_table_take_fd(process_table_t *table, proc_entry_t *entry)
+{
+    int fd = entry->stat_fd;
+    if (fd != -1) {
+        entry->stat_fd = -1;
+        table->cached_fds--;
+    }
+    return fd;
+}
+
+void process_table_close_fd(process_table_t *table, proc_entry_t *entry)
+{
+    if (entry->slot.state == HASH_SLOT_EMPTY || entry->stat_fd == -1) return;
+
+    close(entry->stat_fd);
+    entry->stat_fd = -1;
+    table->cached_fds--;
+}
+
+void process_table_remove(process_table_t *table, proc_entry_t *entry)
+{
+    process_table_close_fd(table, entry);
+    hash_table_remove(&table->table, entry);
+}
+
+void process_table_end_tick(process_table_t *table)
+{
+    for (size_t i = 0; i < table->table.capacity; i++) {
+        proc_entry_t *e = hash_table_slot(&table->table, i);
+        if (e->slot.state == HASH_SLOT_LIVE && e->seen != table->tick) {
+            process_table_remove(table, e);
+        }
+    }
+}
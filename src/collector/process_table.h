@@ -0,0 +1,93 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * process_table.h - Persistent process table keyed by (pid, starttime)
+ */
+
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../include/sysmon.h"
+#include "../util/hash_table.h"
+
+#define PROCESS_TABLE_INITIAL 1024  // Initial slot count (power of two)
+
+// Cumulative /proc/[pid]/io counters
+typedef struct {
+    uint64_t syscr;                 // read()-like system calls
+    uint64_t syscw;                 // write()-like system calls
+    uint64_t read_bytes;            // Bytes fetched from storage
+    uint64_t write_bytes;           // Bytes sent to storage
+} proc_io_t;
+
+// Memory breakdown from /proc/[pid]/smaps_rollup (KB)
+typedef struct {
+    uint64_t pss;                   // Shared pages divided among their users
+    uint64_t uss;                   // Private_Clean + Private_Dirty
+    uint64_t swap;
+} proc_smaps_t;
+
+// Per-process state carried between ticks
+typedef struct {
+    hash_slot_t slot;
+    pid_t pid;
+    unsigned long long starttime;   // Start time in jiffies after boot; tells reused PIDs apart
+    unsigned long long utime;       // User time at the last sample
+    unsigned long long stime;       // System time at the last sample
+    unsigned long seen;             // Tick in which the process was last seen
+    int stat_fd;                    // Cached /proc/[pid]/stat descriptor, or -1
+    int rank;                       // 1-based position in the last top-K, or 0
+    int born;                       // 1-based index in the collector's born-since-last-tick list, or 0
+    proc_io_t io;                   // I/O counters at io_ns
+    uint64_t io_ns;                 // Time the counters are known to be valid for, or 0
+    bool io_denied;                 // /proc/[pid]/io refused; not tried again
+    proc_smaps_t smaps;             // Memory breakdown read at smaps_ns
+    uint64_t smaps_ns;              // Time of the last smaps_rollup read, or 0
+    bool smaps_denied;              // smaps_rollup refused; not tried again
+} proc_entry_t;
+
+// Running processes by (pid, starttime)
+typedef struct {
+    hash_table_t table;
+    size_t cached_fds;              // Entries holding an open stat_fd
+    unsigned long tick;             // Current tick number
+} process_table_t;
+
+// Allocate a table with at least capacity slots
+bool process_table_init(process_table_t *table, size_t capacity);
+
+// Release table storage
+void process_table_free(process_table_t *table);
+
+// Start a new tick; entries not seen before the matching end_tick are retired
+void process_table_begin_tick(process_table_t *table);
+
+// Find or insert the entry for (pid, starttime) and mark it seen this tick.
+// *inserted is set when the process was not in the table. The pointer is
+// valid until the next upsert.
+proc_entry_t *process_table_upsert(process_table_t *table, pid_t pid,
+                                   unsigned long long starttime, bool *inserted);
+
+// Live entry for pid regardless of starttime, or NULL. The pointer is
+// valid until the next upsert.
+proc_entry_t *process_table_find_pid(process_table_t *table, pid_t pid);
+
+// Hand an open stat descriptor to an entry; it is closed when the entry retires
+void process_table_attach_fd(process_table_t *table, proc_entry_t *entry, int fd);
+
+// Detach and return an entry's cached stat descriptor (-1 if none)
+int process_table_take_fd(process_table_t *table, proc_entry_t *entry);
+
+// Close an entry's cached stat descriptor, if any
+void process_table_close_fd(process_table_t *table, proc_entry_t *entry);
+
+// Tombstone a live entry and close its descriptor
+void process_table_remove(process_table_t *table, proc_entry_t *entry);
+
+// Tombstone every entry that was not seen during this tick and close its descriptor
+void process_table_end_tick(process_table_t *table);
+
+#endif /* PROCESS_TABLE_H */
@@ -0,0 +1,263 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * psi_collector.c - Pressure stall information collector
+ * 
+ * Reads /proc/pressure/{cpu,memory,io} each tick. Besides the kernel's
+ * running averages, the stall time since the previous sample is derived
+ * from the cumulative totals, so short stalls show up before avg10
+ * catches up with them.
+ * 
+ * A resource with a configured trigger gets a second descriptor with
+ * "<some|full> <stall us> <window us>" written to it; the kernel then
+ * raises POLLPRI on it whenever that much stall time accumulates within
+ * a window. The collector thread polls these descriptors next to its
+ * timer and runs this collector at once when one fires.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "psi_collector.h"
+#include "../util/config.h"
+#include "../util/error_handler.h"
+#include "../util/time_util.h"
+
+static const char *const resource_names[PSI_RESOURCE_COUNT] = {
+    [PSI_CPU] = "cpu",
+    [PSI_MEMORY] = "memory",
+    [PSI_IO] = "io"
+};
+
+static const char *const resource_paths[PSI_RESOURCE_COUNT] = {
+    [PSI_CPU] = "/proc/pressure/cpu",
+    [PSI_MEMORY] = "/proc/pressure/memory",
+    [PSI_IO] = "/proc/pressure/io"
+};
+
+// Triggers armed when psi.<resource>_trigger is not set
+static const char *const default_triggers[PSI_RESOURCE_COUNT] = {
+    [PSI_CPU] = "",
+    [PSI_MEMORY] = "some 150000 2000000",
+    [PSI_IO] = ""
+};
+
+static struct {
+    bool available;                 // At least one pressure file could be opened
+    procfs_buf_t buf;
+    struct {
+        procfs_file_t file;
+        int trigger_fd;             // Descriptor holding the trigger, or -1
+        uint64_t prev_some;         // Totals at prev_ns
+        uint64_t prev_full;
+        unsigned long triggers;
+        uint64_t last_trigger_ns;
+    } res[PSI_RESOURCE_COUNT];
+    uint64_t prev_ns;               // Time of the last sample, or 0
+} psi = {
+    .res = {
+        { .file = { .fd = -1 }, .trigger_fd = -1 },
+        { .file = { .fd = -1 }, .trigger_fd = -1 },
+        { .file = { .fd = -1 }, .trigger_fd = -1 }
+    }
+};
+
+// Parse a fixed-point percentage such as "12.34"
+static bool parse_percent(procfs_cursor_t *cur, double *out)
+{
+    uint64_t whole;
+    if (!procfs_parse_u64(cur, &whole)) return false;
+
+    double value = (double)whole;
+    if (procfs_consume(cur, ".", 1)) {
+        const char *start = cur->p;
+        uint64_t frac;
+        if (!procfs_parse_u64(cur, &frac)) return false;
+
+        double scale = 1.0;
+        for (const char *p = start; p < cur->p; p++) scale *= 10.0;
+        value += (double)frac / scale;
+    }
+    *out = value;
+    return true;
+}
+
+// "avg10=N avg60=N avg300=N total=N" after the some/full prefix
+static bool parse_line(procfs_cursor_t *line, psi_line_t *out)
+{
+    static const char *const keys[] = { "avg10=", "avg60=", "avg300=" };
+    static const size_t lens[] = { 6, 6, 7 };
+    double *avgs[] = { &out->avg10, &out->avg60, &out->avg300 };
+
+    for (size_t k = 0; k < 3; k++) {
+        procfs_skip_blanks(line);
+        if (!procfs_consume(line, keys[k], lens[k]) || !parse_percent(line, avgs[k])) {
+            return false;
+        }
+    }
+    procfs_skip_blanks(line);
+    if (!procfs_consume(line, "total=", 6) || !procfs_parse_u64(line, &out->total)) {
+        return false;
+    }
+    out->present = true;
+    return true;
+}
+
+bool psi_parse(const procfs_buf_t *buf, psi_line_t *some, psi_line_t *full)
+{
+    *some = (psi_line_t){ 0 };
+    *full = (psi_line_t){ 0 };
+
+    procfs_cursor_t cur = procfs_cursor(buf);
+    procfs_cursor_t line;
+    while (procfs_next_line(&cur, &line)) {
+        if (procfs_consume(&line, "some ", 5)) {
+            parse_line(&line, some);
+        } else if (procfs_consume(&line, "full ", 5)) {
+            parse_line(&line, full);
+        }
+    }
+    return some->present;
+}
+
+// Averages of one line and its stall share since the previous total
+static psi_stall_t to_stall(const psi_line_t *line, uint64_t prev_total, double elapsed_us)
+{
+    psi_stall_t stall = { line->avg10, line->avg60, line->avg300, 0.0 };
+    if (elapsed_us > 0 && line->total >= prev_total) {
+        stall.rate = (double)(line->total - prev_total) / elapsed_us * 100.0;
+        if (stall.rate > 100.0) stall.rate = 100.0;
+    }
+    return stall;
+}
+
+// Register the configured stall threshold of one resource
+static void arm_trigger(psi_resource_t r)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "psi.%s_trigger", resource_names[r]);
+    const char *spec = config_get_string(key, default_triggers[r]);
+    if (!spec[0]) return;
+
+    // The kernel reads the spec up to its terminating NUL
+    int fd = open(resource_paths[r], O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1 || write(fd, spec, strlen(spec) + 1) == -1) {
+        int err = errno;
+        log_warning("Cannot arm %s pressure trigger \"%s\": %s%s", resource_names[r], spec,
+                    strerror(err),
+                    err == EINVAL ? " (without CAP_SYS_RESOURCE the window must be a "
+                                    "multiple of 2 seconds)" : "");
+        if (fd != -1) close(fd);
+        return;
+    }
+    psi.res[r].trigger_fd = fd;
+    log_info("Armed %s pressure trigger \"%s\"", resource_names[r], spec);
+}
+
+bool psi_collector_init(void)
+{
+    if (!procfs_buf_init(&psi.buf, PROCFS_BUF_INITIAL)) {
+        log_error("Memory allocation failed");
+        return false;
+    }
+
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        if (!procfs_file_open(&psi.res[r].file, resource_paths[r])) continue;
+
+        psi.available = true;
+        arm_trigger((psi_resource_t)r);
+    }
+    if (!psi.available) {
+        log_warning("No pressure stall information (kernel without CONFIG_PSI or "
+                    "booted with psi=0), pressure panel disabled");
+        return true;
+    }
+
+    // Prime the totals so the first published sample has rates
+    psi_metrics_t scratch;
+    return psi_collector_collect(&scratch);
+}
+
+bool psi_collector_collect(psi_metrics_t *metrics)
+{
+    if (!metrics) return false;
+
+    *metrics = (psi_metrics_t){ .available = psi.available };
+    if (!psi.available) return true;
+
+    uint64_t now = monotonic_ns();
+    double elapsed_us = psi.prev_ns != 0 && now > psi.prev_ns ?
+                        (double)(now - psi.prev_ns) / 1000.0 : 0.0;
+
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        psi_resource_info_t *info = &metrics->res[r];
+        info->trigger_armed = psi.res[r].trigger_fd != -1;
+        info->triggers = psi.res[r].triggers;
+        info->last_trigger_ns = psi.res[r].last_trigger_ns;
+
+        psi_line_t some, full;
+        if (psi.res[r].file.fd == -1 || !procfs_file_read(&psi.res[r].file, &psi.buf) ||
+            !psi_parse(&psi.buf, &some, &full)) {
+            continue;
+        }
+        info->available = true;
+        info->has_full = full.present;
+        info->some = to_stall(&some, psi.res[r].prev_some, elapsed_us);
+        info->full = to_stall(&full, psi.res[r].prev_full, elapsed_us);
+        psi.res[r].prev_some = some.total;
+        psi.res[r].prev_full = full.total;
+    }
+    psi.prev_ns = now;
+    return true;
+}
+
+int psi_collector_trigger_fds(struct pollfd *fds, int max)
+{
+    int n = 0;
+    for (int r = 0; r < PSI_RESOURCE_COUNT && n < max; r++) {
+        if (psi.res[r].trigger_fd == -1) continue;
+        fds[n++] = (struct pollfd){ .fd = psi.res[r].trigger_fd, .events = POLLPRI };
+    }
+    return n;
+}
+
+bool psi_collector_handle_triggers(const struct pollfd *fds, int count)
+{
+    uint64_t now = monotonic_ns();
+    bool fired = false;
+
+    for (int i = 0; i < count; i++) {
+        if (!fds[i].revents) continue;
+
+        for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+            if (psi.res[r].trigger_fd != fds[i].fd) continue;
+
+            if (fds[i].revents & (POLLERR | POLLNVAL)) {
+                log_warning("%s pressure trigger failed, disarming it", resource_names[r]);
+                close(psi.res[r].trigger_fd);
+                psi.res[r].trigger_fd = -1;
+            } else if (fds[i].revents & POLLPRI) {
+                psi.res[r].triggers++;
+                psi.res[r].last_trigger_ns = now;
+                fired = true;
+            }
+            break;
+        }
+    }
+    return fired;
+}
+
+void psi_collector_cleanup(void)
+{
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        procfs_file_close(&psi.res[r].file);
+        if (psi.res[r].trigger_fd != -1) close(psi.res[r].trigger_fd);
+        psi.res[r].trigger_fd = -1;
+    }
+    procfs_buf_free(&psi.buf);
+    psi.available = false;
+}
@@ -0,0 +1,46 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * psi_collector.h - Pressure stall information collector
+ */
+
+#ifndef PSI_COLLECTOR_H
+#define PSI_COLLECTOR_H
+
+#include <poll.h>
+
+#include "../include/sysmon.h"
+#include "../util/procfs_parse.h"
+
+// One "some" or "full" line of a pressure file
+typedef struct {
+    bool present;
+    double avg10;                   // Percentages
+    double avg60;
+    double avg300;
+    uint64_t total;                 // Cumulative stall time in microseconds
+} psi_line_t;
+
+// Parse the content of a pressure file (/proc/pressure/<resource> or a
+// cgroup's <resource>.pressure). Returns false without a "some" line.
+bool psi_parse(const procfs_buf_t *buf, psi_line_t *some, psi_line_t *full);
+
+// Initialize the pressure collector and arm the configured stall
+// triggers. Without PSI in the kernel the collector keeps running but
+// reports itself unavailable.
+bool psi_collector_init(void);
+
+// Read the pressure of every resource
+bool psi_collector_collect(psi_metrics_t *metrics);
+
+// Fill fds with the armed trigger descriptors, which raise POLLPRI when
+// a stall threshold is crossed. Returns how many were filled in.
+int psi_collector_trigger_fds(struct pollfd *fds, int max);
+
+// Record the triggers that fired; true if any did
+bool psi_collector_handle_triggers(const struct pollfd *fds, int count);
+
+// Clean up pressure collector resources
+void psi_collector_cleanup(void);
+
+#endif /* PSI_COLLECTOR_H */
@@ -0,0 +1,27 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * rtnl_link.h - Interface statistics from an rtnetlink RTM_GETLINK dump
+ */
+
+#ifndef RTNL_LINK_H
+#define RTNL_LINK_H
+
+#include <stddef.h>
+
+#include "../include/sysmon.h"
+
+// Called once per interface; name is not NUL-terminated
+typedef void (*iface_visit_fn)(const char *name, size_t len,
+                               const net_counters_t *counters, void *ctx);
+
+// Open the rtnetlink socket used for the dumps
+bool rtnl_link_open(void);
+
+// Dump every interface with its IFLA_STATS64 counters
+bool rtnl_link_dump(iface_visit_fn visit, void *ctx);
+
+// Close the socket
+void rtnl_link_close(void);
+
+#endif /* RTNL_LINK_H */
@@ -0,0 +1,360 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * sock_index.c - Socket inode to process index built from /proc/<pid>/fd
+ * 
+ * Walking every /proc/<pid>/fd costs a readlink per descriptor, far too
+ * much to repeat every tick. Since Linux 6.2 a stat of /proc/<pid>/fd
+ * reports the descriptor count as its size, so each tick only processes
+ * whose count changed are queued. The queue is drained under a time
+ * budget. A process whose last scan was expensive waits proportionally
+ * longer before the next one, and every process is refreshed after
+ * SOCK_INDEX_REFRESH_NS to catch descriptors replaced one for one.
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "sock_index.h"
+#include "../util/error_handler.h"
+#include "../util/hash_table.h"
+#include "../util/time_util.h"
+
+#define SOCK_INDEX_REFRESH_NS (10 * NSEC_PER_SEC)  // Rescan unchanged processes this often
+#define SOCK_INDEX_COST_FACTOR 50   // Minimum gap between scans, as a multiple of their cost
+#define FD_DIRENT_BUF 16384         // getdents64 buffer for /proc/<pid>/fd
+
+// A process and the socket inodes found by its last fd scan
+typedef struct {
+    hash_slot_t slot;
+    pid_t pid;
+    unsigned long long starttime;
+    int fd_count;                   // Descriptor count at the last scan, -1 if unknown
+    bool queued;                    // Needs a rescan
+    uint64_t scanned_ns;            // CLOCK_MONOTONIC time of the last scan, 0 if never
+    uint64_t scan_cost_ns;          // Duration of the last scan
+    unsigned long seen;             // Tick in which the process was last touched
+    uint64_t *inodes;               // Socket inodes, owned by the entry
+    uint32_t inode_count;
+    uint32_t inode_capacity;
+    double rx_rate;                 // Joined from the last socket dump
+    double tx_rate;
+} owner_t;
+
+// inode -> owning PID. A socket shared across a fork is charged to
+// whichever process was scanned first.
+typedef struct {
+    hash_slot_t slot;
+    uint64_t inode;
+    pid_t pid;
+} inode_slot_t;
+
+static struct {
+    int proc_fd;                    // /proc, owned by the process collector
+    hash_table_t owners;            // owner_t by pid
+    hash_table_t inodes;            // inode_slot_t by inode
+    unsigned long tick;
+    size_t cursor;                  // Owner slot where the last budgeted pass stopped
+    char *dirents;                  // getdents64 buffer
+    uint64_t *scratch;              // Inodes found by the scan in progress
+    size_t scratch_capacity;
+} idx = { .proc_fd = -1 };
+
+static uint32_t hash_pid(pid_t pid)
+{
+    return (uint32_t)pid * 2654435761u;
+}
+
+static uint32_t hash_inode(uint64_t inode)
+{
+    return (uint32_t)((inode * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+static bool pid_equal(const void *entry, const void *key)
+{
+    return ((const owner_t *)entry)->pid == *(const pid_t *)key;
+}
+
+static bool inode_equal(const void *entry, const void *key)
+{
+    return ((const inode_slot_t *)entry)->inode == *(const uint64_t *)key;
+}
+
+// Live owner entry for pid, or NULL
+static owner_t *find_owner(pid_t pid)
+{
+    return hash_table_find(&idx.owners, hash_pid(pid), pid_equal, &pid);
+}
+
+// Slot mapping inode, or NULL
+static inode_slot_t *find_inode(uint64_t inode)
+{
+    return hash_table_find(&idx.inodes, hash_inode(inode), inode_equal, &inode);
+}
+
+// Map inode to pid unless another process already owns it
+static void insert_inode(uint64_t inode, pid_t pid)
+{
+    bool inserted;
+    inode_slot_t *slot = hash_table_upsert(&idx.inodes, hash_inode(inode), inode_equal, &inode,
+                                           &inserted);
+    if (slot && inserted) {
+        slot->inode = inode;
+        slot->pid = pid;
+    }
+}
+
+// Unmap an owner's inodes that still point at it
+static void release_inodes(owner_t *o)
+{
+    for (uint32_t i = 0; i < o->inode_count; i++) {
+        inode_slot_t *slot = find_inode(o->inodes[i]);
+        if (slot && slot->pid == o->pid) hash_table_remove(&idx.inodes, slot);
+    }
+    o->inode_count = 0;
+}
+
+static void remove_owner(owner_t *o)
+{
+    release_inodes(o);
+    free(o->inodes);
+    o->inodes = NULL;
+    o->inode_capacity = 0;
+    hash_table_remove(&idx.owners, o);
+}
+
+bool sock_index_init(int proc_dir_fd)
+{
+    idx.proc_fd = proc_dir_fd;
+    if (!hash_table_init(&idx.owners, sizeof(owner_t), SOCK_INDEX_OWNERS_INITIAL) ||
+        !hash_table_init(&idx.inodes, sizeof(inode_slot_t), SOCK_INDEX_INODES_INITIAL)) {
+        sock_index_cleanup();
+        return false;
+    }
+
+    idx.dirents = malloc(FD_DIRENT_BUF);
+    if (!idx.dirents) {
+        log_error("Memory allocation failed");
+        sock_index_cleanup();
+        return false;
+    }
+    return true;
+}
+
+void sock_index_cleanup(void)
+{
+    for (size_t i = 0; i < idx.owners.capacity; i++) {
+        free(((owner_t *)hash_table_slot(&idx.owners, i))->inodes);
+    }
+    hash_table_free(&idx.owners);
+    hash_table_free(&idx.inodes);
+    free(idx.dirents);
+    free(idx.scratch);
+    memset(&idx, 0, sizeof(idx));
+    idx.proc_fd = -1;
+}
+
+void sock_index_begin_tick(void)
+{
+    idx.tick++;
+}
+
+int sock_index_fd_count(pid_t pid)
+{
+    char path[32];
+    struct stat st;
+    snprintf(path, sizeof(path), "%d/fd", pid);
+
+    // Kernels before 6.2 report a size of 0
+    if (fstatat(idx.proc_fd, path, &st, 0) == -1 || st.st_size <= 0) return -1;
+    return (int)st.st_size;
+}
+
+void sock_index_touch(pid_t pid, unsigned long long starttime, int fd_count)
+{
+    if (!idx.owners.slots) return;
+
+    owner_t *o = find_owner(pid);
+    if (o && o->starttime != starttime) {
+        // PID reused since the last tick
+        remove_owner(o);
+        o = NULL;
+    }
+
+    if (!o) {
+        const unsigned char *slots = idx.owners.slots;
+        bool inserted;
+        o = hash_table_upsert(&idx.owners, hash_pid(pid), pid_equal, &pid, &inserted);
+        if (!o) return;
+
+        // A rehash moved every owner, so the pass position means nothing
+        if (idx.owners.slots != slots) idx.cursor = 0;
+
+        o->pid = pid;
+        o->starttime = starttime;
+        o->fd_count = -1;
+        o->queued = true;
+    } else if (fd_count != -1 && fd_count != o->fd_count) {
+        o->queued = true;
+    }
+    o->seen = idx.tick;
+}
+
+// Append to the scratch inode list
+static bool push_scratch(size_t *count, uint64_t inode)
+{
+    if (*count == idx.scratch_capacity) {
+        size_t capacity = idx.scratch_capacity ? idx.scratch_capacity * 2 : 256;
+        uint64_t *scratch = realloc(idx.scratch, capacity * sizeof(uint64_t));
+        if (!scratch) return false;
+        idx.scratch = scratch;
+        idx.scratch_capacity = capacity;
+    }
+    idx.scratch[(*count)++] = inode;
+    return true;
+}
+
+// List the socket inodes behind a process's descriptors into idx.scratch.
+// Returns the number found, or -1 if the fd directory is unreadable.
+static long read_socket_inodes(pid_t pid)
+{
+    char path[32];
+    snprintf(path, sizeof(path), "%d/fd", pid);
+
+    int dir = openat(idx.proc_fd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir == -1) return -1;
+
+    size_t count = 0;
+    ssize_t n;
+    while ((n = getdents64(dir, idx.dirents, FD_DIRENT_BUF)) > 0) {
+        for (ssize_t off = 0; off < n; ) {
+            const struct dirent64 *d = (const struct dirent64 *)(idx.dirents + off);
+            off += d->d_reclen;
+            if (d->d_name[0] == '.') continue;
+
+            // Socket descriptors read back as "socket:[<inode>]"
+            char target[64];
+            ssize_t len = readlinkat(dir, d->d_name, target, sizeof(target) - 1);
+            if (len < 9 || memcmp(target, "socket:[", 8) != 0) continue;
+            target[len] = '\0';
+
+            uint64_t inode = strtoull(target + 8, NULL, 10);
+            if (inode != 0 && !push_scratch(&count, inode)) break;
+        }
+    }
+    close(dir);
+    return (long)count;
+}
+
+// Replace an owner's inodes with a fresh scan of its descriptors
+static void rescan_owner(owner_t *o, uint64_t now)
+{
+    long found = read_socket_inodes(o->pid);
+    release_inodes(o);
+
+    if (found > 0 && (uint32_t)found > o->inode_capacity) {
+        uint64_t *inodes = realloc(o->inodes, found * sizeof(uint64_t));
+        if (!inodes) found = 0;
+        else {
+            o->inodes = inodes;
+            o->inode_capacity = (uint32_t)found;
+        }
+    }
+    for (long i = 0; i < found; i++) {
+        o->inodes[o->inode_count++] = idx.scratch[i];
+        insert_inode(idx.scratch[i], o->pid);
+    }
+
+    o->fd_count = sock_index_fd_count(o->pid);
+    o->queued = false;
+    o->scanned_ns = monotonic_ns();
+    o->scan_cost_ns = o->scanned_ns - now;
+}
+
+// Rescan owners accepted by want(), starting at the cursor, until the
+// deadline. Returns false if the deadline cut the pass short.
+static bool rescan_pass(bool (*want)(const owner_t*, uint64_t), uint64_t deadline)
+{
+    for (size_t n = 0; n < idx.owners.capacity; n++) {
+        size_t i = (idx.cursor + n) & (idx.owners.capacity - 1);
+        owner_t *o = hash_table_slot(&idx.owners, i);
+        if (o->slot.state != HASH_SLOT_LIVE) continue;
+
+        uint64_t now = monotonic_ns();
+        if (!want(o, now)) continue;
+        if (now >= deadline) {
+            idx.cursor = i;
+            return false;
+        }
+
+        // Expensive processes are rescanned less often
+        if (o->scanned_ns != 0 && now - o->scanned_ns < o->scan_cost_ns * SOCK_INDEX_COST_FACTOR) {
+            continue;
+        }
+        rescan_owner(o, now);
+    }
+    return true;
+}
+
+static bool want_queued(const owner_t *o, uint64_t now)
+{
+    (void)now;
+    return o->queued;
+}
+
+static bool want_stale(const owner_t *o, uint64_t now)
+{
+    return now - o->scanned_ns >= SOCK_INDEX_REFRESH_NS;
+}
+
+void sock_index_end_tick(uint64_t budget_ns)
+{
+    if (!idx.owners.slots) return;
+
+    for (size_t i = 0; i < idx.owners.capacity; i++) {
+        owner_t *o = hash_table_slot(&idx.owners, i);
+        if (o->slot.state == HASH_SLOT_LIVE && o->seen != idx.tick) remove_owner(o);
+    }
+
+    // Changed processes first, then ones not looked at for a while
+    uint64_t deadline = monotonic_ns() + budget_ns;
+    if (rescan_pass(want_queued, deadline)) {
+        rescan_pass(want_stale, deadline);
+    }
+}
+
+bool sock_index_usage(pid_t pid, unsigned long long starttime, sock_usage_t *usage)
+{
+    const owner_t *o = find_owner(pid);
+    if (!o || o->starttime != starttime || o->scanned_ns == 0) return false;
+
+    usage->sockets = o->inode_count;
+    usage->rx_rate = o->rx_rate;
+    usage->tx_rate = o->tx_rate;
+    return true;
+}
+
+void sock_index_clear_traffic(void)
+{
+    for (size_t i = 0; i < idx.owners.capacity; i++) {
+        owner_t *o = hash_table_slot(&idx.owners, i);
+        o->rx_rate = o->tx_rate = 0.0;
+    }
+}
+
+void sock_index_add_traffic(uint64_t inode, double rx_rate, double tx_rate)
+{
+    const inode_slot_t *slot = find_inode(inode);
+    if (!slot) return;
+
+    owner_t *o = find_owner(slot->pid);
+    if (!o) return;
+    o->rx_rate += rx_rate;
+    o->tx_rate += tx_rate;
+}
@@ -0,0 +1,56 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * sock_index.h - Socket inode to process index built from /proc/<pid>/fd
+ */
+
+#ifndef SOCK_INDEX_H
+#define SOCK_INDEX_H
+
+#include <stdint.h>
+
+#include "../include/sysmon.h"
+
+#define SOCK_INDEX_OWNERS_INITIAL 1024  // Initial process slots (power of two)
+#define SOCK_INDEX_INODES_INITIAL 4096  // Initial inode slots (power of two)
+
+// Socket activity attributed to one process
+typedef struct {
+    unsigned int sockets;           // Socket descriptors at the last fd scan
+    double rx_rate;                 // TCP receive rate of those sockets (KB/s)
+    double tx_rate;                 // TCP transmit rate (KB/s)
+} sock_usage_t;
+
+// Allocate the index. proc_dir_fd is an open /proc directory used for
+// every fd scan; it stays owned by the caller.
+bool sock_index_init(int proc_dir_fd);
+
+// Release the index
+void sock_index_cleanup(void);
+
+// Start a new tick; processes not touched before the matching end_tick are dropped
+void sock_index_begin_tick(void);
+
+// Number of descriptors /proc/<pid>/fd reports through its size, or -1
+// when the kernel does not report it or the process is unreadable.
+// Safe to call from any thread.
+int sock_index_fd_count(pid_t pid);
+
+// Mark a process alive this tick. A new process, or one whose fd count
+// changed since its last scan, is queued for a rescan.
+void sock_index_touch(pid_t pid, unsigned long long starttime, int fd_count);
+
+// Drop processes that were not touched and rescan queued ones until
+// budget_ns has been spent. Processes left over wait for the next tick.
+void sock_index_end_tick(uint64_t budget_ns);
+
+// Activity of a process, or false if it is not indexed
+bool sock_index_usage(pid_t pid, unsigned long long starttime, sock_usage_t *usage);
+
+// Forget the traffic joined from the previous socket dump
+void sock_index_clear_traffic(void);
+
+// Charge a socket's byte rates (KB/s) to the process owning inode
+void sock_index_add_traffic(uint64_t inode, double rx_rate, double tx_rate);
+
+#endif /* SOCK_INDEX_H */
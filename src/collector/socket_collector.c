@@ -0,0 +1,340 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * socket_collector.c - TCP/UDP socket collector over sock_diag netlink
+ * 
+ * Sockets are dumped with SOCK_DIAG_BY_FAMILY, which hands back binary
+ * inet_diag_msg records instead of the text of /proc/net/tcp, and the
+ * state filter is part of the request so listeners and TIME_WAIT sockets
+ * never leave the kernel. TCP dumps ask for INET_DIAG_INFO (struct
+ * tcp_info) and each connection's counters are kept between ticks in a
+ * table keyed by the socket cookie.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/inet_diag.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+#include <linux/tcp.h>
+
+#include "socket_collector.h"
+#include "conn_table.h"
+#include "sock_index.h"
+#include "../util/error_handler.h"
+#include "../util/netlink.h"
+#include "../util/time_util.h"
+
+// Kernel TCP states (include/net/tcp_states.h)
+enum {
+    SK_ESTABLISHED = 1,
+    SK_SYN_SENT,
+    SK_SYN_RECV,
+    SK_FIN_WAIT1,
+    SK_FIN_WAIT2,
+    SK_TIME_WAIT,
+    SK_CLOSE,
+    SK_CLOSE_WAIT,
+    SK_LAST_ACK,
+    SK_LISTEN,
+    SK_CLOSING,
+    SK_NEW_SYN_RECV,
+    SK_MAX_STATES
+};
+
+#define STATE_BIT(s) (1u << (s))
+
+// Connections worth ranking: everything but listeners, TIME_WAIT and closed
+#define TCP_TRACKED_STATES (STATE_BIT(SK_ESTABLISHED) | STATE_BIT(SK_SYN_SENT) | \
+                            STATE_BIT(SK_SYN_RECV) | STATE_BIT(SK_FIN_WAIT1) | \
+                            STATE_BIT(SK_FIN_WAIT2) | STATE_BIT(SK_CLOSE_WAIT) | \
+                            STATE_BIT(SK_LAST_ACK) | STATE_BIT(SK_CLOSING))
+
+static const char *const state_names[SK_MAX_STATES] = {
+    [SK_ESTABLISHED] = "ESTAB",
+    [SK_SYN_SENT] = "SYN-SENT",
+    [SK_SYN_RECV] = "SYN-RECV",
+    [SK_FIN_WAIT1] = "FIN-WAIT-1",
+    [SK_FIN_WAIT2] = "FIN-WAIT-2",
+    [SK_TIME_WAIT] = "TIME-WAIT",
+    [SK_CLOSE] = "UNCONN",
+    [SK_CLOSE_WAIT] = "CLOSE-WAIT",
+    [SK_LAST_ACK] = "LAST-ACK",
+    [SK_LISTEN] = "LISTEN",
+    [SK_CLOSING] = "CLOSING",
+    [SK_NEW_SYN_RECV] = "SYN-RECV"
+};
+
+// Ranking candidate: a connection and its combined byte rate
+typedef struct {
+    double bytes_rate;              // rx_rate + tx_rate
+    connection_info_t info;
+} candidate_t;
+
+static struct {
+    nl_socket_t sock;
+    bool available;                 // sock_diag answered the first dump
+    bool have_udp;                  // udp_diag is present
+    conn_table_t conns;
+    uint64_t last_dump_ns;          // Time of the previous TCP dump, 0 before the first
+    candidate_t heap[MAX_TOP_CONNECTIONS];  // Lowest ranked selected entry at the root
+    int heap_count;
+} sd = { .sock = { .fd = -1 } };
+
+// State threaded through one dump
+typedef struct {
+    connection_metrics_t *metrics;
+    uint64_t now;
+} collect_pass_t;
+
+const char *socket_state_name(int state)
+{
+    if (state <= 0 || state >= SK_MAX_STATES || !state_names[state]) return "?";
+    return state_names[state];
+}
+
+// Order candidates busiest first: byte rate, then retransmits, then RTT
+static int compare_candidates(const candidate_t *a, const candidate_t *b)
+{
+    if (a->bytes_rate != b->bytes_rate) return a->bytes_rate > b->bytes_rate ? -1 : 1;
+    if (a->info.retrans_rate != b->info.retrans_rate) {
+        return a->info.retrans_rate > b->info.retrans_rate ? -1 : 1;
+    }
+    if (a->info.rtt_us != b->info.rtt_us) return a->info.rtt_us > b->info.rtt_us ? -1 : 1;
+    return 0;
+}
+
+static int compare_candidates_qsort(const void *a, const void *b)
+{
+    return compare_candidates(a, b);
+}
+
+// Restore the heap property below slot i; the root ranks last
+static void heap_sift_down(candidate_t *heap, int n, int i)
+{
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, worst = i;
+        if (l < n && compare_candidates(&heap[l], &heap[worst]) > 0) worst = l;
+        if (r < n && compare_candidates(&heap[r], &heap[worst]) > 0) worst = r;
+        if (worst == i) return;
+
+        candidate_t tmp = heap[i];
+        heap[i] = heap[worst];
+        heap[worst] = tmp;
+        i = worst;
+    }
+}
+
+static void heap_sift_up(candidate_t *heap, int i)
+{
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (compare_candidates(&heap[i], &heap[parent]) <= 0) return;
+
+        candidate_t tmp = heap[i];
+        heap[i] = heap[parent];
+        heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+// Keep c if it ranks among the best MAX_TOP_CONNECTIONS seen this dump
+static void offer_candidate(const candidate_t *c)
+{
+    if (sd.heap_count < MAX_TOP_CONNECTIONS) {
+        sd.heap[sd.heap_count] = *c;
+        heap_sift_up(sd.heap, sd.heap_count++);
+    } else if (compare_candidates(c, &sd.heap[0]) < 0) {
+        sd.heap[0] = *c;
+        heap_sift_down(sd.heap, sd.heap_count, 0);
+    }
+}
+
+// Per-second rate of a counter; a counter that went backwards restarts at 0
+static double counter_rate(uint64_t now, uint64_t prev, double seconds)
+{
+    return now >= prev ? (double)(now - prev) / seconds : 0.0;
+}
+
+// Copy the addressing part of an inet_diag_msg
+static void fill_endpoints(connection_info_t *info, const struct inet_diag_msg *msg)
+{
+    info->family = msg->idiag_family;
+    info->state = msg->idiag_state;
+    info->local_port = ntohs(msg->id.idiag_sport);
+    info->remote_port = ntohs(msg->id.idiag_dport);
+
+    size_t len = msg->idiag_family == AF_INET6 ? 16 : 4;
+    memset(info->local_addr, 0, sizeof(info->local_addr));
+    memset(info->remote_addr, 0, sizeof(info->remote_addr));
+    memcpy(info->local_addr, msg->id.idiag_src, len);
+    memcpy(info->remote_addr, msg->id.idiag_dst, len);
+}
+
+// Find INET_DIAG_INFO and copy it into a zeroed tcp_info. Older kernels
+// send a shorter structure; the fields they lack stay zero.
+static bool read_tcp_info(const struct nlmsghdr *nlh, struct tcp_info *ti)
+{
+    const struct inet_diag_msg *msg = NLMSG_DATA(nlh);
+    int left = (int)nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*msg));
+
+    memset(ti, 0, sizeof(*ti));
+    const struct rtattr *rta = (const struct rtattr *)(msg + 1);
+    for (; RTA_OK(rta, left); rta = RTA_NEXT(rta, left)) {
+        if (rta->rta_type == INET_DIAG_INFO) {
+            size_t len = RTA_PAYLOAD(rta);
+            memcpy(ti, RTA_DATA(rta), len < sizeof(*ti) ? len : sizeof(*ti));
+            return true;
+        }
+    }
+    return false;
+}
+
+// One TCP socket: counters against its last sample, then offer it for ranking
+static void handle_tcp(const struct nlmsghdr *nlh, void *ctx)
+{
+    collect_pass_t *pass = ctx;
+    const struct inet_diag_msg *msg = NLMSG_DATA(nlh);
+    if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*msg))) return;
+
+    pass->metrics->tcp_count++;
+
+    struct tcp_info ti;
+    if (!read_tcp_info(nlh, &ti)) return;
+
+    uint64_t cookie = (uint64_t)msg->id.idiag_cookie[1] << 32 | msg->id.idiag_cookie[0];
+    bool inserted;
+    conn_entry_t *e = conn_table_upsert(&sd.conns, cookie, &inserted);
+    if (!e) return;
+
+    candidate_t c;
+    fill_endpoints(&c.info, msg);
+    c.info.rtt_us = ti.tcpi_rtt;
+    c.info.total_retrans = ti.tcpi_total_retrans;
+    c.info.rx_rate = c.info.tx_rate = c.info.retrans_rate = 0.0;
+
+    // A socket first seen now opened after the previous dump, so all of
+    // its traffic falls inside this interval. The first dump only primes.
+    uint64_t since = inserted ? sd.last_dump_ns : e->prev_ns;
+    if (since != 0 && pass->now > since) {
+        double seconds = (double)(pass->now - since) / NSEC_PER_SEC;
+        c.info.rx_rate = counter_rate(ti.tcpi_bytes_received, e->bytes_received, seconds) / 1024.0;
+        c.info.tx_rate = counter_rate(ti.tcpi_bytes_acked, e->bytes_acked, seconds) / 1024.0;
+        c.info.retrans_rate = counter_rate(ti.tcpi_total_retrans, e->total_retrans, seconds);
+    }
+    c.bytes_rate = c.info.rx_rate + c.info.tx_rate;
+
+    // Charge the traffic to the owning process; idle sockets add nothing
+    if (c.bytes_rate > 0.0) {
+        sock_index_add_traffic(msg->idiag_inode, c.info.rx_rate, c.info.tx_rate);
+    }
+
+    e->bytes_received = ti.tcpi_bytes_received;
+    e->bytes_acked = ti.tcpi_bytes_acked;
+    e->total_retrans = ti.tcpi_total_retrans;
+    e->prev_ns = pass->now;
+
+    offer_candidate(&c);
+}
+
+static void handle_udp(const struct nlmsghdr *nlh, void *ctx)
+{
+    (void)nlh;
+    collect_pass_t *pass = ctx;
+    pass->metrics->udp_count++;
+}
+
+// Dump one family/protocol pair. Returns 0 or the kernel's errno.
+static int dump_sockets(uint8_t family, uint8_t protocol, uint32_t states, uint8_t ext,
+                        nl_msg_fn fn, collect_pass_t *pass)
+{
+    struct inet_diag_req_v2 req = {
+        .sdiag_family = family,
+        .sdiag_protocol = protocol,
+        .idiag_ext = ext,
+        .idiag_states = states
+    };
+    return nl_dump(&sd.sock, SOCK_DIAG_BY_FAMILY, &req, sizeof(req),
+                   SOCK_DIAG_BY_FAMILY, fn, pass);
+}
+
+bool socket_collector_init(void)
+{
+    if (!conn_table_init(&sd.conns, CONN_TABLE_INITIAL)) return false;
+
+    if (!nl_socket_open(&sd.sock, NETLINK_SOCK_DIAG, NETLINK_RECV_BUF)) {
+        log_warning("sock_diag unavailable: %s", strerror(errno));
+        return true;
+    }
+
+    // Prime the connection table so the first published sample has rates
+    sd.available = true;
+    sd.have_udp = true;
+    connection_metrics_t scratch;
+    if (!socket_collector_collect(&scratch) || !scratch.available) {
+        log_warning("sock_diag dump failed, socket panel disabled");
+        sd.available = false;
+        nl_socket_close(&sd.sock);
+    }
+    return true;
+}
+
+bool socket_collector_collect(connection_metrics_t *metrics)
+{
+    if (!metrics) return false;
+
+    memset(metrics, 0, sizeof(*metrics));
+    if (!sd.available) return true;
+
+    collect_pass_t pass = { .metrics = metrics, .now = monotonic_ns() };
+    const uint8_t families[] = { AF_INET, AF_INET6 };
+
+    sd.heap_count = 0;
+    conn_table_begin_tick(&sd.conns);
+    sock_index_clear_traffic();
+
+    for (size_t i = 0; i < sizeof(families); i++) {
+        int err = dump_sockets(families[i], IPPROTO_TCP, TCP_TRACKED_STATES,
+                               1 << (INET_DIAG_INFO - 1), handle_tcp, &pass);
+        // No IPv6 in this kernel is not an error
+        if (err == 0 || (families[i] == AF_INET6 && err == ENOENT)) continue;
+
+        // Keep the table as it was rather than retiring every connection
+        log_error("TCP socket dump failed: %s", strerror(err));
+        return false;
+    }
+    conn_table_end_tick(&sd.conns);
+    sd.last_dump_ns = pass.now;
+
+    // UDP sockets are only counted
+    for (size_t i = 0; i < sizeof(families) && sd.have_udp; i++) {
+        int err = dump_sockets(families[i], IPPROTO_UDP, ~0u, 0, handle_udp, &pass);
+        if (err == ENOENT && families[i] == AF_INET) {
+            log_info("udp_diag unavailable, UDP sockets not counted");
+            sd.have_udp = false;
+        } else if (err != 0 && err != ENOENT) {
+            log_warning("UDP socket dump failed: %s", strerror(err));
+        }
+    }
+
+    qsort(sd.heap, sd.heap_count, sizeof(candidate_t), compare_candidates_qsort);
+    for (int i = 0; i < sd.heap_count; i++) {
+        metrics->top[i] = sd.heap[i].info;
+    }
+    metrics->count = sd.heap_count;
+    metrics->available = true;
+    return true;
+}
+
+void socket_collector_cleanup(void)
+{
+    nl_socket_close(&sd.sock);
+    conn_table_free(&sd.conns);
+    sd.available = false;
+    sd.last_dump_ns = 0;
+}
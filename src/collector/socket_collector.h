@@ -0,0 +1,25 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * socket_collector.h - TCP/UDP socket collector over sock_diag netlink
+ */
+
+#ifndef SOCKET_COLLECTOR_H
+#define SOCKET_COLLECTOR_H
+
+#include "../include/sysmon.h"
+
+// Initialize the socket collector. A kernel without sock_diag leaves
+// the collector running but reporting itself unavailable.
+bool socket_collector_init(void);
+
+// Dump TCP and UDP sockets and rank the busiest TCP connections
+bool socket_collector_collect(connection_metrics_t *metrics);
+
+// Short name of a kernel TCP state, e.g. "ESTAB"
+const char *socket_state_name(int state);
+
+// Clean up socket collector resources
+void socket_collector_cleanup(void);
+
+#endif /* SOCKET_COLLECTOR_H */
@@ -0,0 +1,168 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * statfs_worker.c - statvfs() on a helper thread with a timeout
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "statfs_worker.h"
+#include "../util/error_handler.h"
+#include "../util/time_util.h"
+
+// One helper thread and the request it is working on. Freed by the
+// collector after a join, or by the thread itself once abandoned.
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;            // Signals posted requests and finished results
+    char path[PATH_MAX];
+    bool posted;                    // A request is waiting to be picked up
+    bool finished;                  // result and err hold the answer
+    bool abandoned;                 // Caller gave up; the thread frees itself
+    bool stopping;
+    int err;
+    struct statvfs result;
+} worker_t;
+
+static worker_t *current;           // Helper used for the next call, or NULL
+static atomic_int hung_count;       // Abandoned helpers still inside statvfs
+
+static void worker_destroy(worker_t *w)
+{
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->lock);
+    free(w);
+}
+
+static void *worker_main(void *arg)
+{
+    worker_t *w = arg;
+
+    pthread_mutex_lock(&w->lock);
+    for (;;) {
+        while (!w->posted && !w->stopping) pthread_cond_wait(&w->cond, &w->lock);
+        if (w->stopping) break;
+        w->posted = false;
+
+        // The caller leaves path alone while the request is in flight
+        pthread_mutex_unlock(&w->lock);
+        struct statvfs st;
+        int err = statvfs(w->path, &st) == 0 ? 0 : errno;
+        pthread_mutex_lock(&w->lock);
+
+        if (w->abandoned) {
+            pthread_mutex_unlock(&w->lock);
+            atomic_fetch_sub(&hung_count, 1);
+            worker_destroy(w);
+            return NULL;
+        }
+        w->result = st;
+        w->err = err;
+        w->finished = true;
+        pthread_cond_signal(&w->cond);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return NULL;
+}
+
+// Start a helper thread with signals blocked, like the collector thread
+static worker_t *worker_start(void)
+{
+    worker_t *w = calloc(1, sizeof(*w));
+    if (!w) {
+        log_error("Memory allocation failed");
+        return NULL;
+    }
+
+    // Timed waits run on the monotonic clock
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    int err = pthread_create(&w->thread, NULL, worker_main, w);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (err != 0) {
+        log_error("Failed to create statvfs thread: %s", strerror(err));
+        worker_destroy(w);
+        return NULL;
+    }
+    return w;
+}
+
+statfs_status_t statfs_worker_call(const char *path, uint64_t timeout_ns,
+                                   struct statvfs *out, int *err)
+{
+    if (!current) {
+        if (atomic_load(&hung_count) >= STATFS_MAX_HUNG) return STATFS_BUSY;
+        current = worker_start();
+        if (!current) {
+            *err = EAGAIN;
+            return STATFS_FAILED;
+        }
+    }
+
+    size_t len = strlen(path);
+    if (len >= sizeof(current->path)) {
+        *err = ENAMETOOLONG;
+        return STATFS_FAILED;
+    }
+
+    worker_t *w = current;
+    struct timespec deadline = ns_to_timespec(monotonic_ns() + timeout_ns);
+
+    pthread_mutex_lock(&w->lock);
+    memcpy(w->path, path, len + 1);
+    w->posted = true;
+    w->finished = false;
+    pthread_cond_signal(&w->cond);
+
+    int rc = 0;
+    while (!w->finished && rc != ETIMEDOUT) {
+        rc = pthread_cond_timedwait(&w->cond, &w->lock, &deadline);
+    }
+
+    if (!w->finished) {
+        // Leave the thread to finish the call and clean up after itself
+        w->abandoned = true;
+        atomic_fetch_add(&hung_count, 1);
+        pthread_mutex_unlock(&w->lock);
+        pthread_detach(w->thread);
+        current = NULL;
+        return STATFS_TIMEOUT;
+    }
+
+    *out = w->result;
+    *err = w->err;
+    pthread_mutex_unlock(&w->lock);
+    return *err == 0 ? STATFS_OK : STATFS_FAILED;
+}
+
+void statfs_worker_shutdown(void)
+{
+    if (!current) return;
+
+    pthread_mutex_lock(&current->lock);
+    current->stopping = true;
+    pthread_cond_signal(&current->cond);
+    pthread_mutex_unlock(&current->lock);
+
+    pthread_join(current->thread, NULL);
+    worker_destroy(current);
+    current = NULL;
+}
@@ -0,0 +1,34 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * statfs_worker.h - statvfs() on a helper thread with a timeout
+ */
+
+#ifndef STATFS_WORKER_H
+#define STATFS_WORKER_H
+
+#include <stdint.h>
+#include <sys/statvfs.h>
+
+#define STATFS_MAX_HUNG 4           // Abandoned calls tolerated before refusing new ones
+
+typedef enum {
+    STATFS_OK,                      // out holds the result
+    STATFS_FAILED,                  // statvfs failed; errno-style code in *err
+    STATFS_TIMEOUT,                 // No answer in time; the call was abandoned
+    STATFS_BUSY                     // Too many abandoned calls still hang
+} statfs_status_t;
+
+/*
+ * A call that does not return within the timeout is left running on its
+ * thread, which exits once the kernel lets go of it; the next call gets
+ * a fresh thread. This keeps a hung network mount from stalling the
+ * collector thread.
+ */
+statfs_status_t statfs_worker_call(const char *path, uint64_t timeout_ns,
+                                   struct statvfs *out, int *err);
+
+// Stop the current helper thread; abandoned ones are left to exit on their own
+void statfs_worker_shutdown(void);
+
+#endif /* STATFS_WORKER_H */
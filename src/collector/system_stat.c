@@ -0,0 +1,198 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * system_stat.c - Shared /proc/stat snapshot implementation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "system_stat.h"
+#include "../util/error_handler.h"
+#include "../util/procfs_parse.h"
+#include "../util/time_util.h"
+
+#define PROC_STAT_PATH "/proc/stat"
+#define STAT_BUFFER_INITIAL 8192
+#define CPU_CORES_INITIAL 64            // Initial per-core capacity
+
+static struct {
+    procfs_file_t file;         // /proc/stat, kept open across ticks
+    procfs_buf_t buf;           // Read buffer, grown to fit the whole file
+    bool fresh;                 // snap matches the current tick
+    system_stat_t snap;
+} st = { .file = { .fd = -1 } };
+
+static void parse_cpu_line(procfs_cursor_t *line, cpu_times_t *t)
+{
+    uint64_t v[10] = {0};
+
+    for (int i = 0; i < 10 && procfs_parse_u64(line, &v[i]); i++) {
+        // Older kernels report fewer columns; missing ones stay zero
+    }
+    t->user = v[0];
+    t->nice = v[1];
+    t->system = v[2];
+    t->idle = v[3];
+    t->iowait = v[4];
+    t->irq = v[5];
+    t->softirq = v[6];
+    t->steal = v[7];
+    t->guest = v[8];
+    t->guest_nice = v[9];
+}
+
+// Append one "cpuN" line to the per-core arrays
+static bool add_core(cpu_core_counters_t *c, int id, const cpu_times_t *t)
+{
+    if (!cpu_core_counters_reserve(c, c->count + 1)) return false;
+
+    int i = c->count++;
+    c->ids[i] = id;
+    c->user[i] = (double)t->user;
+    c->nice[i] = (double)t->nice;
+    c->system[i] = (double)t->system;
+    c->idle[i] = (double)t->idle;
+    c->iowait[i] = (double)t->iowait;
+    c->irq[i] = (double)t->irq;
+    c->softirq[i] = (double)t->softirq;
+    c->steal[i] = (double)t->steal;
+    c->guest[i] = (double)t->guest;
+    c->guest_nice[i] = (double)t->guest_nice;
+    return true;
+}
+
+static bool parse_stat_file(void)
+{
+    system_stat_t *s = &st.snap;
+    procfs_cursor_t cur = procfs_cursor(&st.buf);
+    procfs_cursor_t line;
+    uint64_t value;
+
+    s->cores.count = 0;
+
+    while (procfs_next_line(&cur, &line)) {
+        if (procfs_consume(&line, "cpu", 3)) {
+            if (line.p < line.end && *line.p == ' ') {
+                parse_cpu_line(&line, &s->total);
+            } else if (procfs_parse_u64(&line, &value)) {
+                cpu_times_t t;
+                parse_cpu_line(&line, &t);
+                if (!add_core(&s->cores, (int)value, &t)) return false;
+            }
+        } else if (procfs_consume(&line, "ctxt ", 5)) {
+            if (procfs_parse_u64(&line, &value)) s->ctxt = value;
+        } else if (procfs_consume(&line, "intr ", 5)) {
+            // Only the leading total; per-IRQ columns are skipped with the line
+            if (procfs_parse_u64(&line, &value)) s->intr = value;
+        } else if (procfs_consume(&line, "procs_running ", 14)) {
+            if (procfs_parse_u64(&line, &value)) s->procs_running = (unsigned long)value;
+        } else if (procfs_consume(&line, "procs_blocked ", 14)) {
+            if (procfs_parse_u64(&line, &value)) s->procs_blocked = (unsigned long)value;
+        }
+    }
+    return s->cores.count > 0;
+}
+
+bool system_stat_init(void)
+{
+    if (!procfs_file_open(&st.file, PROC_STAT_PATH)) {
+        log_error("Failed to open %s", PROC_STAT_PATH);
+        return false;
+    }
+
+    if (!procfs_buf_init(&st.buf, STAT_BUFFER_INITIAL)) {
+        log_error("Memory allocation failed");
+        system_stat_cleanup();
+        return false;
+    }
+
+    st.fresh = false;
+    return true;
+}
+
+void system_stat_invalidate(void)
+{
+    st.fresh = false;
+}
+
+const system_stat_t *system_stat_get(void)
+{
+    if (st.fresh) return &st.snap;
+
+    if (!procfs_file_read(&st.file, &st.buf)) {
+        log_error("Failed to read %s", PROC_STAT_PATH);
+        return NULL;
+    }
+
+    st.snap.timestamp_ns = monotonic_ns();
+    if (!parse_stat_file()) {
+        log_error("No CPU lines in %s", PROC_STAT_PATH);
+        return NULL;
+    }
+
+    st.fresh = true;
+    return &st.snap;
+}
+
+unsigned long long cpu_times_total(const cpu_times_t *t)
+{
+    return t->user + t->nice + t->system + t->idle + t->iowait +
+           t->irq + t->softirq + t->steal;
+}
+
+bool cpu_core_counters_reserve(cpu_core_counters_t *c, int n)
+{
+    if (n <= c->capacity) return true;
+
+    int capacity = c->capacity > 0 ? c->capacity : CPU_CORES_INITIAL;
+    while (capacity < n) capacity *= 2;
+
+    double **fields[] = {
+        &c->user, &c->nice, &c->system, &c->idle,
+        &c->iowait, &c->irq, &c->softirq, &c->steal,
+        &c->guest, &c->guest_nice
+    };
+    for (size_t f = 0; f < sizeof(fields)/sizeof(fields[0]); f++) {
+        double *array = realloc(*fields[f], capacity * sizeof(double));
+        if (!array) {
+            log_error("Memory allocation failed");
+            return false;
+        }
+        memset(array + c->capacity, 0, (capacity - c->capacity) * sizeof(double));
+        *fields[f] = array;
+    }
+    int *ids = realloc(c->ids, capacity * sizeof(int));
+    if (!ids) {
+        log_error("Memory allocation failed");
+        return false;
+    }
+    memset(ids + c->capacity, 0, (capacity - c->capacity) * sizeof(int));
+    c->ids = ids;
+    c->capacity = capacity;
+    return true;
+}
+
+void cpu_core_counters_free(cpu_core_counters_t *c)
+{
+    free(c->ids);
+    free(c->user);
+    free(c->nice);
+    free(c->system);
+    free(c->idle);
+    free(c->iowait);
+    free(c->irq);
+    free(c->softirq);
+    free(c->steal);
+    free(c->guest);
+    free(c->guest_nice);
+    memset(c, 0, sizeof(*c));
+}
+
+void system_stat_cleanup(void)
+{
+    procfs_file_close(&st.file);
+    procfs_buf_free(&st.buf);
+    cpu_core_counters_free(&st.snap.cores);
+    st.fresh = false;
+}
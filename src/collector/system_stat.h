@@ -0,0 +1,111 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * system_stat.h - Shared /proc/stat snapshot
+ */
+
+#ifndef SYSTEM_STAT_H
+#define SYSTEM_STAT_H
+
+#include <stdint.h>
+
+#include "../include/sysmon.h"
+
+// Cumulative CPU time counters for one "cpu" line, in jiffies
+typedef struct {
+    unsigned long long user;
+    unsigned long long nice;
+    unsigned long long system;
+    unsigned long long idle;
+    unsigned long long iowait;
+    unsigned long long irq;
+    unsigned long long softirq;
+    unsigned long long steal;
+    unsigned long long guest;
+    unsigned long long guest_nice;
+} cpu_times_t;
+
+#define CPU_LANES 4                     // Per-core arrays are padded to a multiple of this
+
+/*
+ * Per-core counters of the "cpuN" lines, one array per field so a pass
+ * over every core walks contiguous memory. Entries follow /proc/stat,
+ * which lists online CPUs by ascending id; offline CPUs have no line and
+ * so no entry. Counters are held as doubles, which represent jiffy counts
+ * exactly up to 2^53, so the per-core arithmetic needs no integer
+ * conversion. Entries past count up to the padded capacity are zero or
+ * left over from an earlier, larger count.
+ */
+typedef struct {
+    int *ids;                           // N of each "cpuN" line
+    double *user;
+    double *nice;
+    double *system;
+    double *idle;
+    double *iowait;
+    double *irq;
+    double *softirq;
+    double *steal;
+    double *guest;                      // Already counted in user
+    double *guest_nice;                 // Already counted in nice
+    int count;                          // Entries in use
+    int capacity;                       // Allocated entries, a multiple of CPU_LANES
+} cpu_core_counters_t;
+
+// One parsed /proc/stat read
+typedef struct {
+    uint64_t timestamp_ns;              // CLOCK_MONOTONIC time of the read
+    cpu_times_t total;                  // Aggregate "cpu" line
+    cpu_core_counters_t cores;          // Per-core "cpuN" lines
+    unsigned long long ctxt;            // Context switches since boot
+    unsigned long long intr;            // Interrupts serviced since boot
+    unsigned long procs_running;        // Runnable tasks
+    unsigned long procs_blocked;        // Tasks blocked on I/O
+} system_stat_t;
+
+// Open /proc/stat and keep the descriptor for later reads
+bool system_stat_init(void);
+
+// Mark the snapshot stale so the next system_stat_get() re-reads the file
+void system_stat_invalidate(void);
+
+// Current snapshot, reading /proc/stat at most once per invalidation
+const system_stat_t *system_stat_get(void);
+
+// Sum of all time counters excluding guest time, which is already in user/nice
+unsigned long long cpu_times_total(const cpu_times_t *t);
+
+// Make room for at least n cores, keeping existing entries; new entries are zero
+bool cpu_core_counters_reserve(cpu_core_counters_t *c, int n);
+
+#define CPU_CORE_FIELDS 10              // Counter arrays in cpu_core_counters_t
+
+// The counter arrays in declaration order, for code that treats them alike
+static inline void cpu_core_counters_arrays(const cpu_core_counters_t *c,
+                                            double *arrays[CPU_CORE_FIELDS])
+{
+    arrays[0] = c->user;
+    arrays[1] = c->nice;
+    arrays[2] = c->system;
+    arrays[3] = c->idle;
+    arrays[4] = c->iowait;
+    arrays[5] = c->irq;
+    arrays[6] = c->softirq;
+    arrays[7] = c->steal;
+    arrays[8] = c->guest;
+    arrays[9] = c->guest_nice;
+}
+
+// Entries rounded up to whole CPU_LANES blocks
+static inline int cpu_core_counters_padded(const cpu_core_counters_t *c)
+{
+    return (c->count + CPU_LANES - 1) / CPU_LANES * CPU_LANES;
+}
+
+// Release the per-core arrays
+void cpu_core_counters_free(cpu_core_counters_t *c);
+
+// Close the descriptor and release the read buffer
+void system_stat_cleanup(void);
+
+#endif /* SYSTEM_STAT_H */
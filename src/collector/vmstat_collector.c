@@ -0,0 +1,207 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * vmstat_collector.c - Paging, swap, reclaim and fault rate collector
+ * 
+ * /proc/vmstat lists close to 200 "name value" lines, of which only a
+ * few are wanted. The kernel prints them in a fixed order, so the names
+ * are looked up once, when the collector starts, and turned into a map
+ * from line number to counter. Each tick then walks the lines by
+ * position and parses only the mapped ones, without comparing a single
+ * name. Each mapped line still has to have a blank right after the name
+ * length recorded for it, and the line count must not change; a file
+ * that no longer matches has its map rebuilt.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vmstat_collector.h"
+#include "../util/error_handler.h"
+#include "../util/procfs_parse.h"
+#include "../util/time_util.h"
+
+#define PROC_VMSTAT_PATH "/proc/vmstat"
+#define VMSTAT_BUF_INITIAL 8192
+
+// Lines read into each counter. Some counters are split by zone or by
+// reclaimer on newer kernels; all their lines add up to one counter.
+static const struct {
+    const char *name;
+    vmstat_counter_t counter;
+} vmstat_fields[] = {
+    {"pgpgin", VMSTAT_PGPGIN},
+    {"pgpgout", VMSTAT_PGPGOUT},
+    {"pswpin", VMSTAT_PSWPIN},
+    {"pswpout", VMSTAT_PSWPOUT},
+    {"pgfault", VMSTAT_PGFAULT},
+    {"pgmajfault", VMSTAT_PGMAJFAULT},
+    {"pgscan_kswapd", VMSTAT_PGSCAN_KSWAPD},
+    {"pgscan_direct", VMSTAT_PGSCAN_DIRECT},
+    {"pgsteal_kswapd", VMSTAT_PGSTEAL_KSWAPD},
+    {"pgsteal_direct", VMSTAT_PGSTEAL_DIRECT},
+    {"allocstall", VMSTAT_ALLOCSTALL},          // Before Linux 4.10
+    {"allocstall_dma", VMSTAT_ALLOCSTALL},
+    {"allocstall_dma32", VMSTAT_ALLOCSTALL},
+    {"allocstall_normal", VMSTAT_ALLOCSTALL},
+    {"allocstall_movable", VMSTAT_ALLOCSTALL},
+    {"allocstall_device", VMSTAT_ALLOCSTALL},
+    {"oom_kill", VMSTAT_OOM_KILL},
+    {"thp_fault_alloc", VMSTAT_THP_FAULT_ALLOC},
+    {"thp_fault_fallback", VMSTAT_THP_FAULT_FALLBACK},
+    {"thp_collapse_alloc", VMSTAT_THP_COLLAPSE_ALLOC},
+    {"thp_split_page", VMSTAT_THP_SPLIT_PAGE}
+};
+
+#define NUM_VMSTAT_FIELDS (sizeof(vmstat_fields)/sizeof(vmstat_fields[0]))
+
+// What one line of the file holds
+typedef struct {
+    int8_t counter;                 // vmstat_counter_t, or -1 for an unwanted line
+    uint8_t name_len;               // Length of the name before the value
+} line_map_t;
+
+static struct {
+    bool available;                 // /proc/vmstat could be opened and mapped
+    procfs_file_t file;
+    procfs_buf_t buf;
+    line_map_t *map;                // One entry per line
+    int lines;
+    int capacity;
+    uint64_t prev[VMSTAT_COUNTER_COUNT];   // Counts at prev_ns
+    uint64_t prev_ns;               // Time of the last sample, or 0
+} vm = { .file = { .fd = -1 } };
+
+// Counter a line name is read into, or -1
+static int8_t find_counter(const char *name, size_t len)
+{
+    for (size_t i = 0; i < NUM_VMSTAT_FIELDS; i++) {
+        if (strlen(vmstat_fields[i].name) == len &&
+            memcmp(vmstat_fields[i].name, name, len) == 0) {
+            return (int8_t)vmstat_fields[i].counter;
+        }
+    }
+    return -1;
+}
+
+// Map every line of the buffer to its counter
+static bool build_map(void)
+{
+    procfs_cursor_t cur = procfs_cursor(&vm.buf);
+    procfs_cursor_t line;
+    int n = 0;
+
+    while (procfs_next_line(&cur, &line)) {
+        if (n == vm.capacity) {
+            int capacity = vm.capacity > 0 ? vm.capacity * 2 : 256;
+            line_map_t *map = realloc(vm.map, capacity * sizeof(line_map_t));
+            if (!map) {
+                log_error("Memory allocation failed");
+                return false;
+            }
+            vm.map = map;
+            vm.capacity = capacity;
+        }
+
+        const char *name;
+        size_t len;
+        line_map_t entry = { -1, 0 };
+        if (procfs_next_token(&line, &name, &len) && len <= UINT8_MAX) {
+            entry.counter = find_counter(name, len);
+            entry.name_len = (uint8_t)len;
+        }
+        vm.map[n++] = entry;
+    }
+    vm.lines = n;
+    return true;
+}
+
+// Sum the mapped lines into counts; false if the file no longer matches the map
+static bool parse_mapped(uint64_t *counts)
+{
+    procfs_cursor_t cur = procfs_cursor(&vm.buf);
+    procfs_cursor_t line;
+    int n = 0;
+
+    while (procfs_next_line(&cur, &line)) {
+        if (n == vm.lines) return false;
+
+        line_map_t entry = vm.map[n++];
+        if (entry.counter < 0) continue;
+
+        // The value follows the name the line had when it was mapped
+        line.p += entry.name_len;
+        uint64_t value;
+        if (line.p >= line.end || *line.p != ' ' || !procfs_parse_u64(&line, &value)) {
+            return false;
+        }
+        counts[entry.counter] += value;
+    }
+    return n == vm.lines;
+}
+
+bool vmstat_collector_init(void)
+{
+    if (!procfs_buf_init(&vm.buf, VMSTAT_BUF_INITIAL)) {
+        log_error("Memory allocation failed");
+        return false;
+    }
+    if (!procfs_file_open(&vm.file, PROC_VMSTAT_PATH) ||
+        !procfs_file_read(&vm.file, &vm.buf)) {
+        log_warning("Failed to read %s, paging panel disabled", PROC_VMSTAT_PATH);
+        return true;
+    }
+    if (!build_map()) return false;
+
+    vm.available = true;
+    log_info("Mapped %d lines of %s", vm.lines, PROC_VMSTAT_PATH);
+
+    // Prime the counters so the first published sample has rates
+    vmstat_metrics_t scratch;
+    return vmstat_collector_collect(&scratch);
+}
+
+bool vmstat_collector_collect(vmstat_metrics_t *metrics)
+{
+    if (!metrics) return false;
+
+    *metrics = (vmstat_metrics_t){ .available = vm.available };
+    if (!vm.available) return true;
+
+    if (!procfs_file_read(&vm.file, &vm.buf)) {
+        log_error("Failed to read %s", PROC_VMSTAT_PATH);
+        return false;
+    }
+
+    uint64_t counts[VMSTAT_COUNTER_COUNT] = { 0 };
+    if (!parse_mapped(counts)) {
+        log_info("%s layout changed, mapping its lines again", PROC_VMSTAT_PATH);
+        memset(counts, 0, sizeof(counts));
+        if (!build_map() || !parse_mapped(counts)) return false;
+    }
+
+    uint64_t now = monotonic_ns();
+    double seconds = vm.prev_ns != 0 && now > vm.prev_ns ?
+                     (double)(now - vm.prev_ns) / NSEC_PER_SEC : 0.0;
+
+    for (int i = 0; i < VMSTAT_COUNTER_COUNT; i++) {
+        metrics->total[i] = counts[i];
+        if (seconds > 0 && counts[i] >= vm.prev[i]) {
+            metrics->rate[i] = (double)(counts[i] - vm.prev[i]) / seconds;
+        }
+    }
+    memcpy(vm.prev, counts, sizeof(vm.prev));
+    vm.prev_ns = now;
+    return true;
+}
+
+void vmstat_collector_cleanup(void)
+{
+    procfs_file_close(&vm.file);
+    procfs_buf_free(&vm.buf);
+    free(vm.map);
+    vm.map = NULL;
+    vm.lines = vm.capacity = 0;
+    vm.available = false;
+}
@@ -0,0 +1,22 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * vmstat_collector.h - Paging, swap, reclaim and fault rate collector
+ */
+
+#ifndef VMSTAT_COLLECTOR_H
+#define VMSTAT_COLLECTOR_H
+
+#include "../include/sysmon.h"
+
+// Initialize the vmstat collector. Without /proc/vmstat the collector
+// keeps running but reports itself unavailable.
+bool vmstat_collector_init(void);
+
+// Read /proc/vmstat and turn its counters into rates
+bool vmstat_collector_collect(vmstat_metrics_t *metrics);
+
+// Clean up vmstat collector resources
+void vmstat_collector_cleanup(void);
+
+#endif /* VMSTAT_COLLECTOR_H */
@@ -8,17 +8,32 @@
 #define SYSMON_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 // =============================================
 // System Configuration Constants
 // =============================================
 
-#define MAX_CPU_CORES 64  // Maximum number of CPU cores
 #define MAX_PROC_NAME 256  // Maximum length for process names
+#define MAX_INTERFACE_NAME 16  // Interface name length including NUL (IFNAMSIZ)
+#define MAX_DISK_NAME 32  // Block device name length including NUL
+#define MAX_MOUNT_PATH 128  // Displayed mount point length including NUL
+#define MAX_FS_TYPE 32  // Filesystem type name length including NUL
+#define MAX_CGROUP_PATH 128  // Displayed cgroup path length including NUL
 #define MAX_ERROR_MSG 1024  // Maximum length for error messages
 #define UI_REFRESH_RATE 1.0  // UI refresh rate in seconds
-#define MAX_PROCESSES 1024   // Maximum number of processes
+#define CPU_SAMPLE_INTERVAL 0.25     // Default CPU sampling interval in seconds
+#define MEMORY_SAMPLE_INTERVAL 0.25  // Default memory sampling interval in seconds
+#define PROCESS_SAMPLE_INTERVAL 3.0  // Default process table scan interval in seconds
+#define CONNECTION_SAMPLE_INTERVAL 2.0  // Default socket dump interval in seconds
+#define MAX_TOP_CONNECTIONS 16       // Busiest TCP connections kept per snapshot
+#define FILESYSTEM_SAMPLE_INTERVAL 5.0  // Default statvfs sweep interval in seconds
+#define CGROUP_SAMPLE_INTERVAL 2.0   // Default cgroup stat interval in seconds
+#define MAX_TOP_CGROUPS 32           // Busiest cgroups kept per snapshot
+#define PSI_SAMPLE_INTERVAL 1.0      // Default pressure stall sampling interval in seconds
+#define VMSTAT_SAMPLE_INTERVAL 1.0   // Default /proc/vmstat sampling interval in seconds
+#define MIN_SAMPLE_INTERVAL 0.05     // Shortest accepted sampling interval in seconds
 
 // Application version
 #define SYSMON_VERSION_MAJOR     0
@@ -30,13 +45,45 @@
 // Data Structures
 // =============================================
 
+/**
+ * @brief CPU time states broken out per core and in total
+ *
+ * Guest time is reported on its own rather than inside user and nice,
+ * as /proc/stat counts it. Idle is what remains of 100%.
+ */
+typedef enum {
+    CPU_STATE_USER,                     // User mode, excluding guest
+    CPU_STATE_NICE,                     // Niced user mode, excluding guest_nice
+    CPU_STATE_SYSTEM,                   // Kernel mode
+    CPU_STATE_IOWAIT,                   // Idle with I/O outstanding
+    CPU_STATE_IRQ,                      // Hard interrupts
+    CPU_STATE_SOFTIRQ,                  // Soft interrupts
+    CPU_STATE_STEAL,                    // Taken by the hypervisor
+    CPU_STATE_GUEST,                    // Running guests, niced or not
+    CPU_STATE_COUNT
+} cpu_state_t;
+
 /**
  * @brief CPU usage metrics structure
+ *
+ * The per-core arrays are heap storage owned by the structure, one entry
+ * per online CPU in ascending id order. Ids need not be contiguous.
  */
 typedef struct {
-    int num_cores;                      // Number of CPU cores detected
+    int num_cores;                      // Online CPUs
+    int capacity;                       // Allocated entries in the per-core arrays
+    int *core_ids;                      // Kernel CPU number of each entry
+    double *core_usage;                 // Per-core usage percentages
+    double *core_state[CPU_STATE_COUNT]; // Per-core percentage spent in each state
     double total_usage;                 // Total CPU usage percentage
-    double core_usage[MAX_CPU_CORES];   // Per-core usage percentages
+    double total_state[CPU_STATE_COUNT]; // Percentage of all CPUs spent in each state
+    int burst_samples;                  // Burst samples behind the two arrays below, 0 if none
+    double *core_burst_max;             // Per-core highest busy percentage within the interval
+    double *core_burst_p99;             // Per-core 99th percentile busy percentage
+    double ctxt_rate;                   // Context switches per second
+    double intr_rate;                   // Interrupts per second
+    unsigned long procs_running;        // Runnable tasks
+    unsigned long procs_blocked;        // Tasks blocked on I/O
 } cpu_metrics_t;
 
 /**
@@ -60,31 +107,266 @@ typedef struct {
     double swap_usage_percent;          // Swap usage percentage
 } memory_metrics_t;
 
+/**
+ * @brief Paging and reclaim event counters of /proc/vmstat
+ */
+typedef enum {
+    VMSTAT_PGPGIN,                      // KB paged in from block devices
+    VMSTAT_PGPGOUT,                     // KB paged out to block devices
+    VMSTAT_PSWPIN,                      // Pages swapped in
+    VMSTAT_PSWPOUT,                     // Pages swapped out
+    VMSTAT_PGFAULT,                     // Page faults, minor and major
+    VMSTAT_PGMAJFAULT,                  // Faults that waited for I/O
+    VMSTAT_PGSCAN_KSWAPD,               // Pages scanned by kswapd
+    VMSTAT_PGSCAN_DIRECT,               // Pages scanned by allocating tasks
+    VMSTAT_PGSTEAL_KSWAPD,              // Pages reclaimed by kswapd
+    VMSTAT_PGSTEAL_DIRECT,              // Pages reclaimed by allocating tasks
+    VMSTAT_ALLOCSTALL,                  // Allocations that entered direct reclaim
+    VMSTAT_OOM_KILL,                    // Processes killed by the OOM killer
+    VMSTAT_THP_FAULT_ALLOC,             // Huge pages allocated on fault
+    VMSTAT_THP_FAULT_FALLBACK,          // Faults that fell back to small pages
+    VMSTAT_THP_COLLAPSE_ALLOC,          // Huge pages assembled by khugepaged
+    VMSTAT_THP_SPLIT_PAGE,              // Huge pages split into small pages
+    VMSTAT_COUNTER_COUNT
+} vmstat_counter_t;
+
+/**
+ * @brief Paging, swap, reclaim and fault activity
+ */
+typedef struct {
+    bool available;                     // /proc/vmstat readable
+    uint64_t total[VMSTAT_COUNTER_COUNT]; // Counts since boot
+    double rate[VMSTAT_COUNTER_COUNT];  // Per second since the last sample
+} vmstat_metrics_t;
+
+/**
+ * @brief Cumulative counters of one network interface
+ */
+typedef struct {
+    uint64_t rx_bytes;
+    uint64_t rx_packets;
+    uint64_t rx_errors;
+    uint64_t rx_dropped;
+    uint64_t tx_bytes;
+    uint64_t tx_packets;
+    uint64_t tx_errors;
+    uint64_t tx_dropped;
+} net_counters_t;
+
+/**
+ * @brief Per-interface network statistics
+ */
+typedef struct {
+    char name[MAX_INTERFACE_NAME];      // Interface name
+    net_counters_t counters;            // Counters at the last sample
+    double rx_rate;                     // Receive rate (KB/s)
+    double tx_rate;                     // Transmit rate (KB/s)
+    double rx_packet_rate;              // Received packets per second
+    double tx_packet_rate;              // Transmitted packets per second
+} net_interface_t;
+
 /**
  * @brief Network activity metrics structure
+ *
+ * The summary fields describe the busiest non-loopback interface. The
+ * interface array is heap storage owned by the structure, like the
+ * process array.
  */
 typedef struct {
-    char interface[16];                 // Interface name
+    char interface[MAX_INTERFACE_NAME]; // Interface name
     double rx_rate;                     // Receive rate (KB/s)
     double tx_rate;                     // Transmit rate (KB/s)
     double rx_utilization;              // Download utilization percentage
     double tx_utilization;              // Upload utilization percentage
-    unsigned long total_rx;             // Total bytes received
-    unsigned long total_tx;             // Total bytes transmitted
-    unsigned long rx_bytes;             // Bytes received since last check
-    unsigned long tx_bytes;             // Bytes transmitted since last check
+    unsigned long total_rx;             // Total received (KB)
+    unsigned long total_tx;             // Total transmitted (KB)
+    unsigned long rx_bytes;             // Cumulative interface counter (bytes)
+    unsigned long tx_bytes;             // Cumulative interface counter (bytes)
+    net_interface_t *interfaces;        // Every interface, in kernel order
+    int count;                          // Number of interfaces
+    int capacity;                       // Allocated entries
 } network_metrics_t;
 
+/**
+ * @brief One TCP connection as reported by sock_diag
+ */
+typedef struct {
+    uint8_t family;                     // AF_INET or AF_INET6
+    uint8_t state;                      // Kernel TCP state (1 = ESTABLISHED)
+    uint16_t local_port;                // Host byte order
+    uint16_t remote_port;
+    uint8_t local_addr[16];             // Network byte order; first 4 bytes for AF_INET
+    uint8_t remote_addr[16];
+    double rx_rate;                     // bytes_received rate (KB/s)
+    double tx_rate;                     // bytes_acked rate (KB/s)
+    double retrans_rate;                // Retransmitted segments per second
+    uint32_t total_retrans;             // Retransmitted segments since the socket opened
+    uint32_t rtt_us;                    // Smoothed round-trip time
+} connection_info_t;
+
+/**
+ * @brief Socket summary and the busiest TCP connections
+ *
+ * The top array is fixed size, so the section copies without a hook.
+ */
+typedef struct {
+    bool available;                     // sock_diag answered; false leaves the rest zero
+    unsigned int tcp_count;             // TCP sockets in the tracked states
+    unsigned int udp_count;             // UDP sockets of any state
+    int count;                          // Entries used in top
+    connection_info_t top[MAX_TOP_CONNECTIONS]; // Busiest first
+} connection_metrics_t;
+
+/**
+ * @brief Per-device disk statistics
+ */
+typedef struct {
+    char name[MAX_DISK_NAME];           // Device name, e.g. "sda"
+    bool partition;                     // Partition of another device
+    bool virtual_device;                // loop, dm, zram and other virtual devices
+    double read_rate;                   // Read rate (KB/s)
+    double write_rate;                  // Write rate (KB/s)
+    double read_iops;                   // Reads completed per second
+    double write_iops;                  // Writes completed per second
+    double read_await;                  // Average time per completed read (ms)
+    double write_await;                 // Average time per completed write (ms)
+    double await;                       // Average time per completed request (ms)
+    double util;                        // Share of time with requests in flight (%)
+    uint64_t sectors_read;              // 512-byte sectors read since boot
+    uint64_t sectors_written;           // 512-byte sectors written since boot
+} disk_device_t;
+
 /**
  * @brief Disk I/O metrics structure
+ *
+ * The summary fields add up physical whole disks only, so partitions and
+ * stacked virtual devices are not counted twice. The device array holds
+ * the devices selected by configuration and is heap storage owned by the
+ * structure.
  */
 typedef struct {
     double read_rate;                   // Read rate (KB/s)
     double write_rate;                  // Write rate (KB/s)
-    unsigned long total_read;           // Total bytes read
-    unsigned long total_written;        // Total bytes written
+    double read_iops;                   // Reads completed per second
+    double write_iops;                  // Writes completed per second
+    unsigned long total_read;           // Total KB read since boot
+    unsigned long total_written;        // Total KB written since boot
+    disk_device_t *devices;             // Selected devices, in kernel order
+    int count;                          // Number of devices
+    int capacity;                       // Allocated entries
 } disk_metrics_t;
 
+/**
+ * @brief Space and inode usage of one mounted filesystem (sizes in KB)
+ */
+typedef struct {
+    char mount_point[MAX_MOUNT_PATH];   // Where it is mounted, truncated if longer
+    char fstype[MAX_FS_TYPE];           // Filesystem type, e.g. "ext4"
+    bool responding;                    // false: statvfs timed out, values are older
+    uint64_t total;                     // Size
+    uint64_t used;                      // Used space
+    uint64_t available;                 // Space available to unprivileged users
+    double usage_percent;               // used / (used + available), as df reports it
+    uint64_t inodes_total;              // 0 if the filesystem has no inode limit
+    uint64_t inodes_used;
+    double inode_percent;
+} fs_mount_t;
+
+/**
+ * @brief Filesystem usage metrics structure
+ *
+ * Pseudo filesystems and repeated mounts of the same device are left
+ * out. The mount array is heap storage owned by the structure.
+ */
+typedef struct {
+    fs_mount_t *mounts;                 // In mount table order
+    int count;                          // Number of mounts
+    int capacity;                       // Allocated entries
+} filesystem_metrics_t;
+
+/**
+ * @brief State of a process's PSS/USS/swap figures
+ */
+typedef enum {
+    MEM_DETAIL_NONE,                    // Not read yet, or smaps_rollup not readable
+    MEM_DETAIL_FRESH,                   // Read within process.smaps_ttl
+    MEM_DETAIL_STALE                    // Older than that; a refresh is pending
+} mem_detail_t;
+
+/**
+ * @brief Resource usage of one cgroup v2 group
+ */
+typedef struct {
+    char path[MAX_CGROUP_PATH];         // Relative to the cgroup2 mount; long paths keep their end
+    double cpu_usage;                   // CPU usage percentage of the whole machine
+    double throttled_pct;               // Share of CFS periods in which it was throttled
+    double throttled_rate;              // Time spent throttled (ms/s)
+    bool has_memory;                    // memory controller enabled for the group
+    uint64_t mem_current;               // memory.current (KB)
+    uint64_t mem_anon;                  // Anonymous memory from memory.stat (KB)
+    uint64_t mem_file;                  // Page cache from memory.stat (KB)
+    bool has_io;                        // io controller enabled for the group
+    double io_read_rate;                // Read rate from io.stat (KB/s)
+    double io_write_rate;               // Write rate from io.stat (KB/s)
+    bool has_pressure;                  // *.pressure files readable (PSI enabled)
+    double psi_cpu;                     // "some" stall time since the last sample (% of wall time)
+    double psi_memory;
+    double psi_io;
+} cgroup_info_t;
+
+/**
+ * @brief Busiest cgroups by CPU usage
+ *
+ * The top array is fixed size, so the section copies without a hook.
+ */
+typedef struct {
+    bool available;                     // A cgroup2 hierarchy is mounted
+    int total;                          // Groups tracked, root excluded
+    int count;                          // Entries used in top
+    cgroup_info_t top[MAX_TOP_CGROUPS]; // Busiest first
+} cgroup_metrics_t;
+
+/**
+ * @brief Resources reported by Pressure Stall Information
+ */
+typedef enum {
+    PSI_CPU,
+    PSI_MEMORY,
+    PSI_IO,
+    PSI_RESOURCE_COUNT
+} psi_resource_t;
+
+/**
+ * @brief One "some" or "full" line of a pressure file (all in % of wall time)
+ */
+typedef struct {
+    double avg10;                       // Kernel running averages
+    double avg60;
+    double avg300;
+    double rate;                        // Stall time since the previous sample
+} psi_stall_t;
+
+/**
+ * @brief Pressure of one resource and the state of its trigger
+ */
+typedef struct {
+    bool available;                     // /proc/pressure/<resource> readable
+    bool has_full;                      // The file has a "full" line
+    psi_stall_t some;                   // Some tasks stalled
+    psi_stall_t full;                   // All non-idle tasks stalled at once
+    bool trigger_armed;                 // A stall threshold is registered
+    unsigned long triggers;             // Times the threshold was crossed
+    uint64_t last_trigger_ns;           // CLOCK_MONOTONIC time of the last crossing, or 0
+} psi_resource_info_t;
+
+/**
+ * @brief System-wide pressure stall information
+ */
+typedef struct {
+    bool available;                     // The kernel reports PSI
+    psi_resource_info_t res[PSI_RESOURCE_COUNT];
+} psi_metrics_t;
+
 /**
  * @brief Process information structure
  */
@@ -94,18 +376,79 @@ typedef struct {
     double cpu_usage;                   // CPU usage percentage
     double mem_usage;                   // Memory usage percentage
     unsigned long mem_used;             // Memory used (KB)
+    unsigned long long starttime;       // Start time in jiffies after boot
     unsigned long long last_utime;      // Previous user time
     unsigned long long last_stime;      // Previous system time
+    unsigned int sockets;               // Open socket descriptors
+    double net_rx_rate;                 // TCP receive rate of its sockets (KB/s)
+    double net_tx_rate;                 // TCP transmit rate of its sockets (KB/s)
+    double io_read_rate;                // Bytes fetched from storage (KB/s)
+    double io_write_rate;               // Bytes sent to storage (KB/s)
+    double syscr_rate;                  // read()-like system calls per second
+    double syscw_rate;                  // write()-like system calls per second
+    bool io_available;                  // false if /proc/[pid]/io is not readable
+    unsigned long mem_pss;              // Proportional set size (KB)
+    unsigned long mem_uss;              // Private pages only this process maps (KB)
+    unsigned long mem_swap;             // Swapped out (KB)
+    mem_detail_t mem_detail;            // Whether the three above are known
 } process_info_t;
 
+/**
+ * @brief Order of the process list
+ */
+typedef enum {
+    PROCESS_SORT_CPU,                   // CPU% desc, then MEM% desc
+    PROCESS_SORT_IO                     // Disk read + write rate desc, then CPU% desc
+} process_sort_t;
+
 /**
  * @brief Process metrics structure
+ *
+ * The process array is heap storage owned by the structure. It is kept
+ * between ticks and only grows when the process count reaches a new high.
  */
 typedef struct {
-    process_info_t processes[MAX_PROCESSES];  // Array of process info
+    process_info_t *processes;               // Array of process info
     int count;                               // Number of processes
+    int capacity;                            // Allocated entries
+    int sorted;                              // Leading entries already in display order
+    process_sort_t sort;                     // Order of those entries
+    unsigned long generation;                // Changes whenever the entries do
 } process_metrics_t;
 
+// Snapshot section flags, set when the matching collector succeeded
+#define SNAPSHOT_CPU        (1u << 0)
+#define SNAPSHOT_MEMORY     (1u << 1)
+#define SNAPSHOT_NETWORK    (1u << 2)
+#define SNAPSHOT_DISK       (1u << 3)
+#define SNAPSHOT_PROCESSES  (1u << 4)
+#define SNAPSHOT_CONNECTIONS (1u << 5)
+#define SNAPSHOT_FILESYSTEMS (1u << 6)
+#define SNAPSHOT_CGROUPS    (1u << 7)
+#define SNAPSHOT_PRESSURE   (1u << 8)
+#define SNAPSHOT_VMSTAT     (1u << 9)
+
+/**
+ * @brief Complete set of metrics published by the collector thread
+ *
+ * A snapshot is never modified once published; the UI reads it while the
+ * collector thread fills a different buffer.
+ */
+typedef struct {
+    unsigned long sequence;             // Publication counter
+    unsigned int valid;                 // SNAPSHOT_* flags of filled sections
+    cpu_metrics_t cpu;
+    memory_metrics_t memory;
+    network_metrics_t network;
+    disk_metrics_t disk;
+    process_metrics_t processes;
+    connection_metrics_t connections;
+    filesystem_metrics_t filesystems;
+    cgroup_metrics_t cgroups;
+    psi_metrics_t pressure;
+    vmstat_metrics_t vmstat;
+} sysmon_snapshot_t;
+
 // Log levels for util functions
 typedef enum {
     LOG_DEBUG,
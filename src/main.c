@@ -2,49 +2,117 @@
  * main.c - Entry point and application controller
  */
 
- #define _POSIX_C_SOURCE 199309L
+ #define _POSIX_C_SOURCE 200809L
+ #include <errno.h>
  #include <signal.h>
+ #include <stdio.h>
  #include <stdlib.h>
  #include <time.h>
  #include <unistd.h> 
+ #include <sys/epoll.h>
+ #include <sys/signalfd.h>
  
  #include "include/sysmon.h"
+ #include "collector/collector_thread.h"
  #include "collector/cpu_collector.h"
  #include "collector/memory_collector.h"
  #include "collector/network_collector.h"
  #include "collector/disk_collector.h"
+ #include "collector/filesystem_collector.h"
+ #include "collector/cgroup_collector.h"
+ #include "collector/psi_collector.h"
+ #include "collector/vmstat_collector.h"
  #include "collector/process_collector.h"
+ #include "collector/socket_collector.h"
+ #include "collector/system_stat.h"
  #include "ui/ui_manager.h"
+ #include "util/config.h"
  #include "util/error_handler.h"
  #include "util/logger.h"
  
+#define MAX_EVENTS 8
+
+// Event loop file descriptors
+static int g_epoll_fd = -1;
+static int g_signal_fd = -1;
+
 // Global flag for graceful shutdown
-static volatile sig_atomic_t g_resize_requested = 0;
-static volatile sig_atomic_t g_shutdown_requested = 0;
+static bool g_shutdown_requested = false;
 
-static void handle_signal(int signal_number)
+// Configuration file, overridable with -c
+static const char *g_config_path = CONFIG_DEFAULT_PATH;
+
+// Parse command-line options
+static bool parse_arguments(int argc, char *argv[])
 {
-    if (signal_number == SIGWINCH) {
-        g_resize_requested = 1; // Set resize flag
-    } else {
-        g_shutdown_requested = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:h")) != -1) {
+        switch (opt) {
+        case 'c':
+            g_config_path = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-c config_file]\n", argv[0]);
+            return false;
+        }
     }
+    return true;
 }
 
+// Block the signals we care about and route them through a signalfd
 static int initialize_signal_handlers(void)
 {
     const int signals[] = {SIGINT, SIGTERM, SIGWINCH};
     const size_t num_signals = sizeof(signals) / sizeof(signals[0]);
-    
+    sigset_t mask;
+
+    sigemptyset(&mask);
     for (size_t i = 0; i < num_signals; i++) {
-        if (signal(signals[i], handle_signal) == SIG_ERR) {
-            log_error("Failed to set up signal handler %d", signals[i]);
-            return 0;
-        }
+        sigaddset(&mask, signals[i]);
+    }
+
+    // Blocked before any thread or ncurses handler exists, so every
+    // delivery ends up queued on the signalfd
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) == -1) {
+        log_error("Failed to block signals");
+        return 0;
+    }
+
+    g_signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (g_signal_fd == -1) {
+        log_error("Failed to create signalfd");
+        return 0;
     }
     return 1;
 }
 
+// Start the collector thread and build the epoll set watching signals,
+// snapshot notifications and stdin
+static bool initialize_event_loop(void)
+{
+    if (!collector_thread_start()) {
+        log_error("Failed to start collector thread");
+        return false;
+    }
+
+    g_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (g_epoll_fd == -1) {
+        log_error("Failed to create epoll instance");
+        return false;
+    }
+
+    const int fds[] = {g_signal_fd, collector_thread_notify_fd(), STDIN_FILENO};
+    for (size_t i = 0; i < sizeof(fds)/sizeof(fds[0]); i++) {
+        struct epoll_event ev = { .events = EPOLLIN, .data.fd = fds[i] };
+        if (epoll_ctl(g_epoll_fd, EPOLL_CTL_ADD, fds[i], &ev) == -1) {
+            log_error("Failed to add fd %d to epoll set", fds[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
 // Core initialization of all subsystems
 bool initialize_subsystems(void)
 {
@@ -53,15 +121,26 @@ bool initialize_subsystems(void)
         return false;
     }
 
+    if (!config_load(g_config_path)) {
+        log_error("Failed to load configuration from %s", g_config_path);
+        return false;
+    }
+
     const struct {
         bool (*init_func)(void);
         const char *name;
     } subsystems[] = {
+        {(bool(*)(void))system_stat_init, "System stat reader"},
         {(bool(*)(void))cpu_collector_init, "CPU collector"},
         {(bool(*)(void))memory_collector_init, "Memory collector"},
+        {(bool(*)(void))vmstat_collector_init, "vmstat collector"},
         {(bool(*)(void))network_collector_init, "Network collector"},
         {(bool(*)(void))disk_collector_init, "Disk collector"},
         {(bool(*)(void))process_collector_init, "Process collector"},
+        {(bool(*)(void))socket_collector_init, "Socket collector"},
+        {(bool(*)(void))filesystem_collector_init, "Filesystem collector"},
+        {(bool(*)(void))cgroup_collector_init, "cgroup collector"},
+        {(bool(*)(void))psi_collector_init, "Pressure collector"},
         {(bool(*)(void))ui_init, "UI manager"}
     };
 
@@ -75,107 +154,135 @@ bool initialize_subsystems(void)
     return true;
 }
 
-// Collect and display metrics
-static void collect_and_display_metrics(void)
+// Render every valid section of a snapshot
+static void display_snapshot(const sysmon_snapshot_t *snap)
 {
-    cpu_metrics_t cpu_metrics;
-    memory_metrics_t memory_metrics;
-    network_metrics_t network_metrics;
-    disk_metrics_t disk_metrics;
-    process_metrics_t process_metrics;
-
-    struct {
-        bool (*collect)(void*);
+    const struct {
         void (*update)(const void*);
-        void *data;
-        const char *name;
-    } collectors[] = {
-        {
-            .collect = (bool(*)(void*))cpu_collector_collect,
-            .update = (void(*)(const void*))ui_update_cpu,
-            .data = &cpu_metrics,
-            .name = "CPU"
-        },
-        {
-            .collect = (bool(*)(void*))memory_collector_collect,
-            .update = (void(*)(const void*))ui_update_memory,
-            .data = &memory_metrics,
-            .name = "Memory"
-        },
-        {
-            .collect = (bool(*)(void*))network_collector_collect,
-            .update = (void(*)(const void*))ui_update_network,
-            .data = &network_metrics,
-            .name = "Network"
-        },
-        {
-            .collect = (bool(*)(void*))disk_collector_collect,
-            .update = (void(*)(const void*))ui_update_disk,
-            .data = &disk_metrics,
-            .name = "Disk"
-        },
-        {
-            .collect = (bool(*)(void*))process_collector_collect,
-            .update = (void(*)(const void*))ui_update_processes,
-            .data = &process_metrics,
-            .name = "Process"
-        }
+        const void *data;
+        unsigned int flag;
+    } panels[] = {
+        {(void(*)(const void*))ui_update_cpu, &snap->cpu, SNAPSHOT_CPU},
+        {(void(*)(const void*))ui_update_memory, &snap->memory, SNAPSHOT_MEMORY},
+        {(void(*)(const void*))ui_update_pressure, &snap->pressure, SNAPSHOT_PRESSURE},
+        {(void(*)(const void*))ui_update_vmstat, &snap->vmstat, SNAPSHOT_VMSTAT},
+        {(void(*)(const void*))ui_update_network, &snap->network, SNAPSHOT_NETWORK},
+        {(void(*)(const void*))ui_update_disk, &snap->disk, SNAPSHOT_DISK},
+        {(void(*)(const void*))ui_update_processes, &snap->processes, SNAPSHOT_PROCESSES},
+        {(void(*)(const void*))ui_update_connections, &snap->connections, SNAPSHOT_CONNECTIONS},
+        {(void(*)(const void*))ui_update_filesystems, &snap->filesystems, SNAPSHOT_FILESYSTEMS},
+        {(void(*)(const void*))ui_update_cgroups, &snap->cgroups, SNAPSHOT_CGROUPS}
     };
 
-    for (size_t i = 0; i < sizeof(collectors)/sizeof(collectors[0]); i++) {
-        if (!collectors[i].collect(collectors[i].data)) {
-            log_error("%s data collection failed", collectors[i].name);
-            continue;
+    for (size_t i = 0; i < sizeof(panels)/sizeof(panels[0]); i++) {
+        if (snap->valid & panels[i].flag) {
+            panels[i].update(panels[i].data);
         }
-        collectors[i].update(collectors[i].data);
+    }
+    ui_refresh();
+}
+
+// Redraw the current snapshot, e.g. after a resize or scroll
+static void redisplay_snapshot(void)
+{
+    const sysmon_snapshot_t *snap = collector_thread_acquire();
+    if (snap) {
+        display_snapshot(snap);
+    }
+}
+
+// Drain pending signals from the signalfd
+static void handle_signals(void)
+{
+    struct signalfd_siginfo info;
+
+    while (read(g_signal_fd, &info, sizeof(info)) == sizeof(info)) {
+        if (info.ssi_signo == SIGWINCH) {
+            ui_handle_resize();
+            redisplay_snapshot();
+        } else {
+            g_shutdown_requested = true;
+        }
+    }
+}
+
+// Render the newest snapshot published by the collector thread
+static void handle_snapshot(void)
+{
+    collector_thread_ack();
+
+    const sysmon_snapshot_t *snap = collector_thread_acquire();
+    if (snap) {
+        display_snapshot(snap);
     }
 }
 
 // Main application loop
 static void main_loop(void)
 {
-    struct timespec last_update;
-    clock_gettime(CLOCK_MONOTONIC, &last_update);
+    struct epoll_event events[MAX_EVENTS];
 
     while (!g_shutdown_requested) {
-        struct timespec current_time;
-        clock_gettime(CLOCK_MONOTONIC, &current_time);
-
-        double time_diff = (current_time.tv_sec - last_update.tv_sec) + 
-                         (current_time.tv_nsec - last_update.tv_nsec) / 1e9;
-        
-        if (g_resize_requested) {
-            g_resize_requested = 0;
-            ui_handle_resize();
+        // Sleep until a signal, a new snapshot or a keypress arrives
+        int n = epoll_wait(g_epoll_fd, events, MAX_EVENTS, -1);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            log_error("epoll_wait failed");
+            break;
         }
 
-        if (time_diff >= 1.0) {
-            collect_and_display_metrics();
-            ui_refresh();
-            last_update = current_time;
-        }
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
 
-        ui_handle_input();
-        sleep(1); // 1s sleep to reduce CPU usage
+            if (fd == g_signal_fd) {
+                handle_signals();
+            } else if (fd == collector_thread_notify_fd()) {
+                handle_snapshot();
+            } else if (fd == STDIN_FILENO) {
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    g_shutdown_requested = true;
+                } else if (ui_handle_input()) {
+                    redisplay_snapshot();
+                }
+            }
+        }
     }
 }
 
+// Close event loop file descriptors
+static void cleanup_event_loop(void)
+{
+    collector_thread_stop();
+    if (g_epoll_fd != -1) close(g_epoll_fd);
+    if (g_signal_fd != -1) close(g_signal_fd);
+    g_epoll_fd = g_signal_fd = -1;
+}
+
 // cleanup all subsystems
 static void cleanup_subsystems(void)
 {
+    cleanup_event_loop();
     ui_cleanup();
+    psi_collector_cleanup();
+    vmstat_collector_cleanup();
+    cgroup_collector_cleanup();
+    filesystem_collector_cleanup();
+    socket_collector_cleanup();
     process_collector_cleanup();
     disk_collector_cleanup();
     network_collector_cleanup();
     memory_collector_cleanup();
     cpu_collector_cleanup();
+    system_stat_cleanup();
     error_handler_cleanup();
 }
 
 // main function
 int main(int argc, char *argv[])
 {
-    (void)argc; (void)argv; // Unused parameters
+    if (!parse_arguments(argc, argv)) {
+        return EXIT_FAILURE;
+    }
 
     if (!initialize_signal_handlers()) {
         return EXIT_FAILURE;
@@ -185,6 +292,11 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    if (!initialize_event_loop()) {
+        cleanup_subsystems();
+        return EXIT_FAILURE;
+    }
+
     main_loop();
     cleanup_subsystems();
 
@@ -7,12 +7,19 @@
 #define _POSIX_C_SOURCE 200809L
 #include <ncurses.h>
 #include <string.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <signal.h>
 #include <unistd.h> 
+#include <arpa/inet.h>
+#include <sys/socket.h>
 
 #include "ui_manager.h"
+#include "../collector/process_collector.h"
+#include "../collector/socket_collector.h"
 #include "../util/error_handler.h"
+#include "../util/time_util.h"
 
 // Window layout configuration
 typedef struct {
@@ -29,6 +36,7 @@ typedef struct {
     int bar_high;
     int bar_medium;
     int bar_low;
+    int cpu_state[CPU_STATE_COUNT];     // Segments of the CPU breakdown bar
 } ui_attributes_t;
 
 // UI component dimensions
@@ -47,16 +55,117 @@ static struct {
     window_layout_t network;
     window_layout_t disk;
     window_layout_t processes;
+    window_layout_t connections;
+    window_layout_t filesystems;
+    window_layout_t cgroups;
     window_layout_t footer;
     ui_attributes_t attr;
     ui_dimensions_t dim;
 } ui;
 
-// Draw a horizontal progress bar
-static void draw_progress_bar(WINDOW *win, int y, int x, double percent, int attr) 
+#define HEADER_HEIGHT 3
+#define FOOTER_HEIGHT 3
+
+// Panels stacked between header and footer, top to bottom. A panel that
+// does not fit the terminal gets no window and is skipped when drawing.
+static const struct {
+    window_layout_t *layout;
+    int height;
+    const char *title;
+} panel_layout[] = {
+    { &ui.cpu, 7, "CPU Usage" },
+    { &ui.memory, 7, "Memory Usage" },
+    { &ui.network, 7, "Network Activity" },
+    { &ui.disk, 8, "Disk I/O" },
+    { &ui.processes, 13, "Processes" },
+    { &ui.connections, 10, "Connections" },
+    { &ui.filesystems, 8, "Filesystems" },
+    { &ui.cgroups, 10, "Control Groups" }
+};
+
+#define NUM_PANELS (sizeof(panel_layout)/sizeof(panel_layout[0]))
+
+#define PSI_TRIGGER_HOLD_SECONDS 10     // A fired stall trigger stays highlighted this long
+
+// Process panel scrolling. The collector only orders the first
+// metrics->sorted entries; rows past them are ordered here on demand.
+// Until the collector catches up with a new sort order, every row is.
+static struct {
+    int scroll;                         // Index of the first row shown
+    process_sort_t sort;                // Order the user asked for
+    const process_info_t **tail;        // Sorted view of the unordered tail
+    int tail_capacity;
+    const process_info_t *tail_base;    // Array the view points into
+    unsigned long tail_generation;      // Generation the view was built for
+    process_sort_t tail_sort;           // Order the view was built in
+    bool show_mem;                      // PSS/USS/swap columns on
+} proc_view;
+
+// What the memory panel shows; pressure and paging have no panels of
+// their own so they stay next to CPU and memory on any terminal tall
+// enough for processes
+typedef enum {
+    MEM_VIEW_USAGE,                     // RAM and swap, with pressure and paging summaries
+    MEM_VIEW_PRESSURE,                  // Full pressure stall table
+    MEM_VIEW_PAGING,                    // Full paging and reclaim rates
+    MEM_VIEW_COUNT
+} mem_view_t;
+
+#define MEM_PAGING_COLUMN 46            // Paging summary column on the swap row, past any swap text
+
+static mem_view_t mem_view;
+
+// Order of the per-core rows in the CPU panel
+typedef enum {
+    CPU_SORT_ID,                        // Ascending CPU number
+    CPU_SORT_STEAL,                     // Steal time desc
+    CPU_SORT_IOWAIT                     // I/O wait desc
+} cpu_sort_t;
+
+// CPU panel view. order is reused across redraws and only grows when the
+// core count reaches a new high.
+static struct {
+    cpu_sort_t sort;
+    int *order;                         // Core entries in display order
+    int order_capacity;
+} cpu_view;
+
+static const char *const cpu_state_labels[CPU_STATE_COUNT] = {
+    [CPU_STATE_USER] = "usr",
+    [CPU_STATE_NICE] = "nic",
+    [CPU_STATE_SYSTEM] = "sys",
+    [CPU_STATE_IOWAIT] = "iow",
+    [CPU_STATE_IRQ] = "irq",
+    [CPU_STATE_SOFTIRQ] = "sirq",
+    [CPU_STATE_STEAL] = "st",
+    [CPU_STATE_GUEST] = "gst"
+};
+
+#define CPU_LEGEND_COLUMNS 90           // Width of the breakdown legend next to the bar
+#define CPU_BURST_COLUMNS 45            // Width of the burst summary after the totals
+#define CPU_BAR_MIN_COLUMNS 30          // Narrowest bar the legend may shrink it to
+
+#define PROCESS_WIDE_COLUMNS 120        // Width that fits socket and disk columns together
+#define PROCESS_MEM_COLUMNS 25          // Width of the PSS/USS/swap group
+
+// Format a size in KB with a binary unit suffix, e.g. "12.4G"
+static void format_size(char *buf, size_t size, uint64_t kb)
+{
+    static const char units[] = "KMGTPE";
+    double value = (double)kb;
+    int unit = 0;
+    while (value >= 1024.0 && units[unit + 1]) {
+        value /= 1024.0;
+        unit++;
+    }
+    snprintf(buf, size, value < 10.0 ? "%.1f%c" : "%.0f%c", value, units[unit]);
+}
+
+// Draw a horizontal progress bar width cells wide
+static void draw_progress_bar(WINDOW *win, int y, int x, int width, double percent, int attr) 
 {
-    int fill_width = (int)(ui.dim.bar_width * percent / 100.0);
-    fill_width = (fill_width > ui.dim.bar_width) ? ui.dim.bar_width : fill_width;
+    int fill_width = (int)(width * percent / 100.0);
+    fill_width = (fill_width > width) ? width : fill_width;
 
     wattron(win, attr);
     for (int i = 0; i < fill_width; i++) {
@@ -65,6 +174,27 @@ static void draw_progress_bar(WINDOW *win, int y, int x, double percent, int att
     wattroff(win, attr);
 }
 
+// Draw the per-state shares of one CPU or all of them as a stacked bar
+// width cells wide. Segment edges are rounded from the running sum so
+// the segments add up to the rounded total.
+static void draw_cpu_breakdown(WINDOW *win, int y, int x, int width, const double *state)
+{
+    double sum = 0.0;
+    int start = 0;
+    for (int s = 0; s < CPU_STATE_COUNT; s++) {
+        sum += state[s];
+        int end = (int)(width * sum / 100.0 + 0.5);
+        if (end > width) end = width;
+
+        wattron(win, ui.attr.cpu_state[s]);
+        for (int i = start; i < end; i++) {
+            mvwaddch(win, y, x + i, ' ');
+        }
+        wattroff(win, ui.attr.cpu_state[s]);
+        if (end > start) start = end;
+    }
+}
+
 // Get color attribute based on usage percentage
 static int get_usage_color(double percent) 
 {
@@ -98,6 +228,18 @@ static bool init_colors(void)
     ui.attr.bar_medium = COLOR_PAIR(5);
     ui.attr.bar_low = COLOR_PAIR(6);
 
+    init_pair(7, COLOR_WHITE, COLOR_BLUE);    // Nice time
+    init_pair(8, COLOR_WHITE, COLOR_MAGENTA); // I/O wait
+    init_pair(9, COLOR_BLACK, COLOR_CYAN);    // Steal
+    ui.attr.cpu_state[CPU_STATE_USER] = COLOR_PAIR(6);
+    ui.attr.cpu_state[CPU_STATE_NICE] = COLOR_PAIR(7);
+    ui.attr.cpu_state[CPU_STATE_SYSTEM] = COLOR_PAIR(4);
+    ui.attr.cpu_state[CPU_STATE_IOWAIT] = COLOR_PAIR(8);
+    ui.attr.cpu_state[CPU_STATE_IRQ] = COLOR_PAIR(5);
+    ui.attr.cpu_state[CPU_STATE_SOFTIRQ] = COLOR_PAIR(5);
+    ui.attr.cpu_state[CPU_STATE_STEAL] = COLOR_PAIR(9);
+    ui.attr.cpu_state[CPU_STATE_GUEST] = COLOR_PAIR(3);
+
     return true;
 }
 
@@ -120,6 +262,50 @@ static bool init_window(window_layout_t *win, int height, int y_pos, const char
     return true;
 }
 
+// Create the header, every panel that fits, and the footer on the last rows
+static bool create_windows(void)
+{
+    int footer_y = ui.dim.max_y - FOOTER_HEIGHT;
+
+    if (!init_window(&ui.header, HEADER_HEIGHT, 0, NULL)) return false;
+
+    int y = HEADER_HEIGHT;
+    for (size_t i = 0; i < NUM_PANELS; i++) {
+        window_layout_t *panel = panel_layout[i].layout;
+        if (y + panel_layout[i].height > footer_y) {
+            panel->win = NULL;
+            continue;
+        }
+        if (!init_window(panel, panel_layout[i].height, y, panel_layout[i].title)) return false;
+        y += panel_layout[i].height;
+    }
+
+    if (!init_window(&ui.footer, FOOTER_HEIGHT, footer_y, NULL)) return false;
+
+    // Draw header
+    wattron(ui.header.win, ui.attr.header);
+    mvwprintw(ui.header.win, 1, (ui.dim.max_x - 15) / 2, "sysmon v%s", SYSMON_VERSION);
+    wattroff(ui.header.win, ui.attr.header);
+
+    // Draw footer
+    wattron(ui.footer.win, ui.attr.header);
+    mvwprintw(ui.footer.win, 1, 2, "q: Quit  Up/Down/PgUp/PgDn: Scroll processes  c/i: Sort by CPU/disk I/O  m: PSS/USS/swap  s/w: Cores by steal/iowait  p: Memory/pressure/paging");
+    wattroff(ui.footer.win, ui.attr.header);
+    return true;
+}
+
+// Delete every window that was created
+static void destroy_windows(void)
+{
+    if (ui.header.win) delwin(ui.header.win);
+    for (size_t i = 0; i < NUM_PANELS; i++) {
+        if (panel_layout[i].layout->win) delwin(panel_layout[i].layout->win);
+        panel_layout[i].layout->win = NULL;
+    }
+    if (ui.footer.win) delwin(ui.footer.win);
+    ui.header.win = ui.footer.win = NULL;
+}
+
 // Initialize the UI system
 bool ui_init(void) 
 {
@@ -129,7 +315,7 @@ bool ui_init(void)
     noecho();
     keypad(stdscr, TRUE);
     curs_set(0);
-    timeout(100);  // 100ms input timeout
+    nodelay(stdscr, TRUE);  // Input is read only when the event loop reports stdin readable
 
     if (!init_colors()) {
         endwin();
@@ -142,28 +328,46 @@ bool ui_init(void)
     ui.dim.cores_per_row = 4;
 
     // Initialize windows
-    if (!init_window(&ui.header, 3, 0, NULL) ||
-        !init_window(&ui.cpu, 7, 3, "CPU Usage") ||
-        !init_window(&ui.memory, 7, 10, "Memory Usage") ||
-        !init_window(&ui.network, 7, 17, "Network Activity") ||
-        !init_window(&ui.disk, 7, 24, "Disk I/O") ||
-        !init_window(&ui.processes, 13, 31, "Processes") || 
-        !init_window(&ui.footer, 3, ui.dim.max_y - 3, NULL)) {
+    if (!create_windows()) {
         ui_cleanup();
         return false;
     }
 
-    // Draw header
-    wattron(ui.header.win, ui.attr.header);
-    mvwprintw(ui.header.win, 1, (ui.dim.max_x - 15) / 2, "sysmon v%s", SYSMON_VERSION);
-    wattroff(ui.header.win, ui.attr.header);
+    ui_refresh();
+    return true;
+}
 
-    // Draw footer
-    wattron(ui.footer.win, ui.attr.header);
-    mvwprintw(ui.footer.win, 1, 2, "q: Quit");
-    wattroff(ui.footer.win, ui.attr.header);
+// Share of the state the cores are sorted by, for compare_cores
+static const double *core_sort_key;
 
-    ui_refresh();
+// qsort comparator: larger share first, then ascending CPU number
+static int compare_cores(const void *a, const void *b)
+{
+    int i = *(const int *)a, j = *(const int *)b;
+    if (core_sort_key[i] != core_sort_key[j]) return core_sort_key[i] < core_sort_key[j] ? 1 : -1;
+    return i - j;
+}
+
+// Fill cpu_view.order with the core entries in the order the user picked
+static bool sort_cores(const cpu_metrics_t *metrics)
+{
+    int n = metrics->num_cores;
+    if (n > cpu_view.order_capacity) {
+        int *order = realloc(cpu_view.order, n * sizeof(*order));
+        if (!order) {
+            log_error("Memory allocation failed");
+            return false;
+        }
+        cpu_view.order = order;
+        cpu_view.order_capacity = n;
+    }
+
+    for (int i = 0; i < n; i++) cpu_view.order[i] = i;
+    if (cpu_view.sort == CPU_SORT_ID) return true;
+
+    core_sort_key = metrics->core_state[cpu_view.sort == CPU_SORT_STEAL ? CPU_STATE_STEAL
+                                                                         : CPU_STATE_IOWAIT];
+    qsort(cpu_view.order, n, sizeof(*cpu_view.order), compare_cores);
     return true;
 }
 
@@ -174,31 +378,73 @@ void ui_update_cpu(const cpu_metrics_t *metrics)
 
     werase(ui.cpu.win);
     box(ui.cpu.win, 0, 0);
-    mvwprintw(ui.cpu.win, 0, 2, " CPU Usage ");
+    mvwprintw(ui.cpu.win, 0, 2, " CPU Usage (%d cores%s) ", metrics->num_cores,
+              cpu_view.sort == CPU_SORT_STEAL ? ", by steal" :
+              cpu_view.sort == CPU_SORT_IOWAIT ? ", by I/O wait" : "");
 
     // Display total CPU usage
-    mvwprintw(ui.cpu.win, 1, 2, "Total: %5.1f%%", metrics->total_usage);
-    draw_progress_bar(ui.cpu.win, 2, 2, metrics->total_usage, 
-                     get_usage_color(metrics->total_usage));
+    mvwprintw(ui.cpu.win, 1, 2, "Total: %5.1f%%   Ctx/s: %-9.0f Intr/s: %-9.0f Run: %-4lu Blocked: %lu",
+             metrics->total_usage, metrics->ctxt_rate, metrics->intr_rate,
+             metrics->procs_running, metrics->procs_blocked);
+
+    // Busiest core's burst figures, when the sampler runs and they fit
+    if (metrics->burst_samples > 0 && getmaxx(ui.cpu.win) - getcurx(ui.cpu.win) > CPU_BURST_COLUMNS) {
+        double max = 0.0, p99 = 0.0;
+        for (int i = 0; i < metrics->num_cores; i++) {
+            if (metrics->core_burst_max[i] > max) max = metrics->core_burst_max[i];
+            if (metrics->core_burst_p99[i] > p99) p99 = metrics->core_burst_p99[i];
+        }
+        wprintw(ui.cpu.win, "  Burst max: %3.0f%%  p99: %3.0f%% (%d samples)",
+                max, p99, metrics->burst_samples);
+    }
+
+    // Breakdown bar, with a legend beside it when the panel is wide enough
+    int bar_width = ui.dim.bar_width;
+    if (bar_width >= CPU_LEGEND_COLUMNS + CPU_BAR_MIN_COLUMNS) {
+        bar_width -= CPU_LEGEND_COLUMNS;
+        wmove(ui.cpu.win, 2, 2 + bar_width + 1);
+        for (int s = 0; s < CPU_STATE_COUNT; s++) {
+            wattron(ui.cpu.win, ui.attr.cpu_state[s]);
+            waddch(ui.cpu.win, ' ');
+            wattroff(ui.cpu.win, ui.attr.cpu_state[s]);
+            wprintw(ui.cpu.win, "%s %4.1f ", cpu_state_labels[s], metrics->total_state[s]);
+        }
+    }
+    draw_cpu_breakdown(ui.cpu.win, 2, 2, bar_width, metrics->total_state);
+
+    if (!sort_cores(metrics)) return;
 
-    // Display per-core usage
+    // Display per-core usage, as many rows as fit above the border. When
+    // sorted by a state, each core also shows its share of that state,
+    // otherwise its burst max and p99 if the sampler runs.
+    cpu_state_t key = cpu_view.sort == CPU_SORT_STEAL ? CPU_STATE_STEAL : CPU_STATE_IOWAIT;
     int core_width = ui.dim.bar_width / ui.dim.cores_per_row;
-    for (int i = 0; i < metrics->num_cores && i < MAX_CPU_CORES; i++) {
-        int row = i / ui.dim.cores_per_row;
-        int col = i % ui.dim.cores_per_row;
+    bool show_key = cpu_view.sort != CPU_SORT_ID && core_width >= 26;
+    bool show_burst = metrics->burst_samples > 0 && core_width >= 33;
+    int max_rows = getmaxy(ui.cpu.win) - 4;
+    for (int n = 0; n < metrics->num_cores; n++) {
+        int row = n / ui.dim.cores_per_row;
+        int col = n % ui.dim.cores_per_row;
         int x_pos = 2 + col * core_width;
 
-        if (row > 3) break;  // Limit to 4 rows
+        if (row >= max_rows) break;
 
+        int i = cpu_view.order[n];
         mvwprintw(ui.cpu.win, 3 + row, x_pos, "CPU%d: %5.1f%%", 
-                 i, metrics->core_usage[i]);
+                 metrics->core_ids[i], metrics->core_usage[i]);
+        if (show_key) {
+            wprintw(ui.cpu.win, "  %s %5.1f%%", cpu_state_labels[key], metrics->core_state[key][i]);
+        } else if (show_burst) {
+            wprintw(ui.cpu.win, "  max %3.0f p99 %3.0f",
+                    metrics->core_burst_max[i], metrics->core_burst_p99[i]);
+        }
     } 
 }
 
 // Update memory metrics display
 void ui_update_memory(const memory_metrics_t *metrics) 
 {
-    if (!metrics || !ui.memory.win) return;
+    if (!metrics || !ui.memory.win || mem_view != MEM_VIEW_USAGE) return;
 
     werase(ui.memory.win);
     box(ui.memory.win, 0, 0);
@@ -211,7 +457,7 @@ void ui_update_memory(const memory_metrics_t *metrics)
     // Display memory usage
     mvwprintw(ui.memory.win, 1, 2, "Memory: %.1f MB / %.1f MB (%.1f%%)", 
              used_mb, total_mb, metrics->usage_percent);
-    draw_progress_bar(ui.memory.win, 2, 2, metrics->usage_percent,
+    draw_progress_bar(ui.memory.win, 2, 2, ui.dim.bar_width, metrics->usage_percent,
                      get_usage_color(metrics->usage_percent));
 
     // Display memory details
@@ -224,10 +470,197 @@ void ui_update_memory(const memory_metrics_t *metrics)
 
     mvwprintw(ui.memory.win, 5, 2, "Swap: %.1f MB / %.1f MB (%.1f%%)",
              swap_used_mb, swap_total_mb, metrics->swap_usage_percent);
-    draw_progress_bar(ui.memory.win, 6, 2, metrics->swap_usage_percent,
+    draw_progress_bar(ui.memory.win, 6, 2, ui.dim.bar_width, metrics->swap_usage_percent,
                      get_usage_color(metrics->swap_usage_percent));
 }
 
+// Append text at the cursor if all of it fits before the right border
+static bool print_if_room(WINDOW *win, int attr, const char *text)
+{
+    if (getmaxx(win) - 1 - getcurx(win) < (int)strlen(text)) return false;
+
+    wattron(win, attr);
+    wprintw(win, "%s", text);
+    wattroff(win, attr);
+    return true;
+}
+
+// True while a fired stall trigger is still worth pointing out
+static bool trigger_recent(const psi_resource_info_t *res, uint64_t now)
+{
+    return res->last_trigger_ns != 0 &&
+           now - res->last_trigger_ns < PSI_TRIGGER_HOLD_SECONDS * NSEC_PER_SEC;
+}
+
+// One row of avg10 and since-last-sample figures under the memory figures
+static void draw_pressure_summary(WINDOW *win, const psi_metrics_t *metrics)
+{
+    static const char *const names[PSI_RESOURCE_COUNT] = { "cpu", "memory", "io" };
+    char text[96];
+
+    wmove(win, 4, 2);
+    if (!metrics->available) {
+        print_if_room(win, ui.attr.normal, "Pressure: not available");
+        return;
+    }
+
+    print_if_room(win, ui.attr.normal, "Pressure avg10/now:");
+    uint64_t now = monotonic_ns();
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        const psi_resource_info_t *res = &metrics->res[r];
+        if (!res->available) continue;
+
+        int len = snprintf(text, sizeof(text), "  %s %.2f/%.1f%%", names[r],
+                           res->some.avg10, res->some.rate);
+        if (res->has_full && r != PSI_CPU) {
+            snprintf(text + len, sizeof(text) - len, " full %.2f/%.1f%%",
+                     res->full.avg10, res->full.rate);
+        }
+        if (!print_if_room(win, get_usage_color(res->some.avg10), text)) return;
+    }
+
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        if (!trigger_recent(&metrics->res[r], now)) continue;
+        snprintf(text, sizeof(text), "  %s trigger FIRED %lu", names[r], metrics->res[r].triggers);
+        if (!print_if_room(win, ui.attr.bar_high, text)) return;
+    }
+}
+
+// Update pressure stall display: a summary row in the memory panel, or
+// the full table when the panel is switched to it
+void ui_update_pressure(const psi_metrics_t *metrics)
+{
+    static const char *const names[PSI_RESOURCE_COUNT] = { "cpu", "memory", "io" };
+
+    if (!metrics || !ui.memory.win) return;
+
+    WINDOW *win = ui.memory.win;
+    if (mem_view == MEM_VIEW_USAGE) {
+        draw_pressure_summary(win, metrics);
+        return;
+    }
+    if (mem_view != MEM_VIEW_PRESSURE) return;
+
+    werase(win);
+    box(win, 0, 0);
+    mvwprintw(win, 0, 2, " Pressure Stall (%% of time tasks waited) ");
+
+    if (!metrics->available) {
+        mvwprintw(win, 1, 2, "Pressure stall information not available");
+        return;
+    }
+
+    mvwprintw(win, 1, 2, "%-7s %6s %6s %6s %6s   %6s %6s %6s %6s   %s", "",
+              "SOME10", "60", "300", "NOW", "FULL10", "60", "300", "NOW", "TRIGGER");
+
+    uint64_t now = monotonic_ns();
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        const psi_resource_info_t *res = &metrics->res[r];
+        mvwprintw(win, 2 + r, 2, "%-7s ", names[r]);
+        if (!res->available) {
+            wprintw(win, "not available");
+            continue;
+        }
+
+        wprintw(win, "%6.2f %6.2f %6.2f %6.1f   ",
+                res->some.avg10, res->some.avg60, res->some.avg300, res->some.rate);
+        if (res->has_full) {
+            wprintw(win, "%6.2f %6.2f %6.2f %6.1f   ",
+                    res->full.avg10, res->full.avg60, res->full.avg300, res->full.rate);
+        } else {
+            wprintw(win, "%6s %6s %6s %6s   ", "-", "-", "-", "-");
+        }
+
+        if (!res->trigger_armed) {
+            wprintw(win, "off");
+        } else if (trigger_recent(res, now)) {
+            wattron(win, ui.attr.bar_high);
+            wprintw(win, "FIRED %lu", res->triggers);
+            wattroff(win, ui.attr.bar_high);
+        } else {
+            wprintw(win, "armed %lu", res->triggers);
+        }
+    }
+}
+
+// Paging rates that point at memory trouble, after the swap figures
+static void draw_paging_summary(WINDOW *win, const vmstat_metrics_t *metrics)
+{
+    const double *rate = metrics->rate;
+    char text[64];
+
+    if (!metrics->available || getmaxx(win) <= MEM_PAGING_COLUMN) return;
+    wmove(win, 5, MEM_PAGING_COLUMN);
+
+    snprintf(text, sizeof(text), "Swap in/out: %.0f / %.0f pages/s",
+             rate[VMSTAT_PSWPIN], rate[VMSTAT_PSWPOUT]);
+    if (!print_if_room(win, ui.attr.normal, text)) return;
+
+    snprintf(text, sizeof(text), "   Major faults: %.0f/s", rate[VMSTAT_PGMAJFAULT]);
+    if (!print_if_room(win, ui.attr.normal, text)) return;
+
+    snprintf(text, sizeof(text), "   Reclaim stalls: %.0f/s", rate[VMSTAT_ALLOCSTALL]);
+    if (!print_if_room(win, rate[VMSTAT_ALLOCSTALL] > 0 ? ui.attr.bar_medium : ui.attr.normal,
+                       text)) {
+        return;
+    }
+
+    snprintf(text, sizeof(text), "   OOM kills: %lu", (unsigned long)metrics->total[VMSTAT_OOM_KILL]);
+    print_if_room(win, rate[VMSTAT_OOM_KILL] > 0 ? ui.attr.bar_high : ui.attr.normal, text);
+}
+
+// Update paging and reclaim display: a summary on the memory panel's
+// swap row, or every rate when the panel is switched to them
+void ui_update_vmstat(const vmstat_metrics_t *metrics)
+{
+    if (!metrics || !ui.memory.win) return;
+
+    WINDOW *win = ui.memory.win;
+    if (mem_view == MEM_VIEW_USAGE) {
+        draw_paging_summary(win, metrics);
+        return;
+    }
+    if (mem_view != MEM_VIEW_PAGING) return;
+
+    werase(win);
+    box(win, 0, 0);
+    mvwprintw(win, 0, 2, " Paging and Reclaim ");
+
+    if (!metrics->available) {
+        mvwprintw(win, 1, 2, "/proc/vmstat not available");
+        return;
+    }
+
+    const double *rate = metrics->rate;
+    mvwprintw(win, 1, 2,
+              "Faults: %8.0f/s  major: %6.0f/s    Paging in/out: %8.1f / %8.1f KB/s",
+              rate[VMSTAT_PGFAULT], rate[VMSTAT_PGMAJFAULT],
+              rate[VMSTAT_PGPGIN], rate[VMSTAT_PGPGOUT]);
+
+    mvwprintw(win, 2, 2, "Swap in/out: %6.0f / %6.0f pages/s    Direct reclaim stalls: ",
+              rate[VMSTAT_PSWPIN], rate[VMSTAT_PSWPOUT]);
+    // Allocations waiting on reclaim and OOM kills are the signs of thrashing
+    int stall_attr = rate[VMSTAT_ALLOCSTALL] > 0 ? ui.attr.bar_medium : ui.attr.normal;
+    wattron(win, stall_attr);
+    wprintw(win, "%5.0f/s", rate[VMSTAT_ALLOCSTALL]);
+    wattroff(win, stall_attr);
+    wprintw(win, "    OOM kills: ");
+    int oom_attr = rate[VMSTAT_OOM_KILL] > 0 ? ui.attr.bar_high : ui.attr.normal;
+    wattron(win, oom_attr);
+    wprintw(win, "%lu", (unsigned long)metrics->total[VMSTAT_OOM_KILL]);
+    wattroff(win, oom_attr);
+
+    mvwprintw(win, 3, 2,
+              "Scanned kswapd/direct: %8.0f / %8.0f    Reclaimed: %8.0f / %8.0f pages/s",
+              rate[VMSTAT_PGSCAN_KSWAPD], rate[VMSTAT_PGSCAN_DIRECT],
+              rate[VMSTAT_PGSTEAL_KSWAPD], rate[VMSTAT_PGSTEAL_DIRECT]);
+
+    mvwprintw(win, 4, 2,
+              "THP fault/fallback: %6.0f / %6.0f    collapse: %6.0f    split: %6.0f /s",
+              rate[VMSTAT_THP_FAULT_ALLOC], rate[VMSTAT_THP_FAULT_FALLBACK],
+              rate[VMSTAT_THP_COLLAPSE_ALLOC], rate[VMSTAT_THP_SPLIT_PAGE]);
+}
+
 // Update network metrics display
 void ui_update_network(const network_metrics_t *metrics) {
     if (!metrics || !ui.network.win) return;
@@ -236,13 +669,33 @@ void ui_update_network(const network_metrics_t *metrics) {
     box(ui.network.win, 0, 0);
     mvwprintw(ui.network.win, 0, 2, " Network Usage ");
 
+    // Find the primary interface's full record
+    const net_interface_t *primary = NULL;
+    for (int i = 0; i < metrics->count; i++) {
+        if (strcmp(metrics->interfaces[i].name, metrics->interface) == 0) {
+            primary = &metrics->interfaces[i];
+            break;
+        }
+    }
+
     // Display primary interface stats
-    mvwprintw(ui.network.win, 1, 2, "Interface: %-10s", metrics->interface);
+    mvwprintw(ui.network.win, 1, 2, "Interface: %-16s (%d interfaces)",
+              metrics->interface, metrics->count);
     
     // Display transfer rates with better formatting
     mvwprintw(ui.network.win, 2, 2, "Download: %8.2f KB/s", metrics->rx_rate);
     mvwprintw(ui.network.win, 3, 2, "Upload:   %8.2f KB/s", metrics->tx_rate);
 
+    if (primary) {
+        mvwprintw(ui.network.win, 2, 32, "%8.0f pkt/s", primary->rx_packet_rate);
+        mvwprintw(ui.network.win, 3, 32, "%8.0f pkt/s", primary->tx_packet_rate);
+        mvwprintw(ui.network.win, 4, 2, "Errors: %llu/%llu  Drops: %llu/%llu (rx/tx)",
+                  (unsigned long long)primary->counters.rx_errors,
+                  (unsigned long long)primary->counters.tx_errors,
+                  (unsigned long long)primary->counters.rx_dropped,
+                  (unsigned long long)primary->counters.tx_dropped);
+    }
+
     // Display totals with ASCII arrows instead of Unicode
     mvwprintw(ui.network.win, 5, 2, "Total RX: %8.1f MB", metrics->total_rx/1024.0);
     mvwprintw(ui.network.win, 6, 2, "Total TX: %8.1f MB", metrics->total_tx/1024.0);
@@ -255,23 +708,87 @@ void ui_update_disk(const disk_metrics_t *metrics)
 
     werase(ui.disk.win);
     box(ui.disk.win, 0, 0);
-    mvwprintw(ui.disk.win, 0, 2, " Disk I/O ");
+    mvwprintw(ui.disk.win, 0, 2, " Disk I/O (%d devices) ", metrics->count);
+
+    // Physical disks combined
+    mvwprintw(ui.disk.win, 1, 2, "Read: %8.1f KB/s %6.0f IOPS   Write: %8.1f KB/s %6.0f IOPS   "
+              "Total: %.1f MB read, %.1f MB written",
+              metrics->read_rate, metrics->read_iops, metrics->write_rate, metrics->write_iops,
+              metrics->total_read / 1024.0, metrics->total_written / 1024.0);
+
+    mvwprintw(ui.disk.win, 2, 2, "%-12s %10s %10s %8s %8s %8s %8s %6s",
+              "DEVICE", "RD KB/s", "WR KB/s", "R/s", "W/s", "R AWAIT", "W AWAIT", "%UTIL");
+
+    int max_rows = ui.disk.height - 4;
+    for (int i = 0; i < metrics->count && i < max_rows; i++) {
+        const disk_device_t *d = &metrics->devices[i];
+        mvwprintw(ui.disk.win, 3 + i, 2, "%-12s %10.1f %10.1f %8.1f %8.1f %8.2f %8.2f ",
+                  d->name, d->read_rate, d->write_rate, d->read_iops, d->write_iops,
+                  d->read_await, d->write_await);
+
+        wattron(ui.disk.win, get_usage_color(d->util));
+        wprintw(ui.disk.win, "%6.1f", d->util);
+        wattroff(ui.disk.win, get_usage_color(d->util));
+    }
+}
 
-    // Display read stats
-    mvwprintw(ui.disk.win, 1, 2, "Read: %6.1f KB/s", metrics->read_rate);
-    draw_progress_bar(ui.disk.win, 2, 2, 
-                    metrics->read_rate / 10.0,  // Scale to 1000KB/s = 100%
-                    get_usage_color(metrics->read_rate / 10.0));
+// qsort comparator for the tail view
+static int compare_process_ptrs(const void *a, const void *b)
+{
+    return process_comparator(proc_view.sort)(*(const process_info_t * const *)a,
+                                              *(const process_info_t * const *)b);
+}
+
+// Make sure proc_view.tail orders the entries past the first sorted ones
+static bool order_process_tail(const process_metrics_t *metrics, int sorted)
+{
+    if (proc_view.tail_base == metrics->processes &&
+        proc_view.tail_generation == metrics->generation &&
+        proc_view.tail_sort == proc_view.sort) {
+        return true;
+    }
+
+    int n = metrics->count - sorted;
+    if (n > proc_view.tail_capacity) {
+        const process_info_t **tail = realloc(proc_view.tail, n * sizeof(*tail));
+        if (!tail) {
+            log_error("Memory allocation failed");
+            return false;
+        }
+        proc_view.tail = tail;
+        proc_view.tail_capacity = n;
+    }
 
-    // Display write stats
-    mvwprintw(ui.disk.win, 3, 2, "Write: %6.1f KB/s", metrics->write_rate);
-    draw_progress_bar(ui.disk.win, 4, 2,
-                    metrics->write_rate / 10.0,  // Scale to 1000KB/s = 100%
-                    get_usage_color(metrics->write_rate / 10.0));
+    for (int i = 0; i < n; i++) {
+        proc_view.tail[i] = &metrics->processes[sorted + i];
+    }
+    qsort(proc_view.tail, n, sizeof(*proc_view.tail), compare_process_ptrs);
 
-    // Display totals
-    mvwprintw(ui.disk.win, 5, 2, "Total Read: %.1f MB", metrics->total_read / 1024.0);
-    mvwprintw(ui.disk.win, 6, 2, "Total Written: %.1f MB", metrics->total_written / 1024.0);
+    proc_view.tail_base = metrics->processes;
+    proc_view.tail_generation = metrics->generation;
+    proc_view.tail_sort = proc_view.sort;
+    return true;
+}
+
+// Draw one row's PSS/USS/swap; figures past their TTL are dimmed and
+// marked '~' until the collector has read them again
+static void draw_process_memory(const process_info_t *p)
+{
+    WINDOW *win = ui.processes.win;
+    if (p->mem_detail == MEM_DETAIL_NONE) {
+        wprintw(win, "%7s %7s %7s  ", "-", "-", "-");
+        return;
+    }
+
+    char pss[16], uss[16], swap[16];
+    format_size(pss, sizeof(pss), p->mem_pss);
+    format_size(uss, sizeof(uss), p->mem_uss);
+    format_size(swap, sizeof(swap), p->mem_swap);
+
+    bool stale = p->mem_detail == MEM_DETAIL_STALE;
+    if (stale) wattron(win, A_DIM);
+    wprintw(win, "%7s %7s %7s%c ", pss, uss, swap, stale ? '~' : ' ');
+    if (stale) wattroff(win, A_DIM);
 }
 
 // Update process metrics display
@@ -280,92 +797,339 @@ void ui_update_processes(const process_metrics_t *metrics) {
 
     werase(ui.processes.win);
     box(ui.processes.win, 0, 0);
-    mvwprintw(ui.processes.win, 0, 2, " Processes ");
 
     if (metrics->count == 0) {
+        mvwprintw(ui.processes.win, 0, 2, " Processes ");
         mvwprintw(ui.processes.win, 1, 2, "No active processes");
         return;
     }
 
+    int max_rows = ui.processes.height - 3;
+    int max_scroll = metrics->count > max_rows ? metrics->count - max_rows : 0;
+    if (proc_view.scroll > max_scroll) proc_view.scroll = max_scroll;
+    if (proc_view.scroll < 0) proc_view.scroll = 0;
+
+    int first = proc_view.scroll;
+    int last = first + max_rows < metrics->count ? first + max_rows : metrics->count;
+
+    // Rows past the collector's top-K need the full ordering, and so does
+    // every row until the collector has switched to a new sort order
+    int sorted = metrics->sort == proc_view.sort ? metrics->sorted : 0;
+    bool have_tail = last <= sorted || order_process_tail(metrics, sorted);
+
+    mvwprintw(ui.processes.win, 0, 2, " Processes %d-%d of %d, by %s ",
+              first + 1, last, metrics->count,
+              proc_view.sort == PROCESS_SORT_IO ? "disk I/O" : "CPU");
+
+    // Socket and disk columns fit side by side on wide terminals;
+    // otherwise only the group matching the sort order is shown
+    int spare = ui.dim.max_x - (proc_view.show_mem ? PROCESS_MEM_COLUMNS : 0);
+    bool wide = spare >= PROCESS_WIDE_COLUMNS;
+    bool show_net = wide || proc_view.sort == PROCESS_SORT_CPU;
+    bool show_io = wide || proc_view.sort == PROCESS_SORT_IO;
+
     // Header
-    mvwprintw(ui.processes.win, 1, 2, "%-6s %6s %6s %-20s",
-             "PID", "CPU%", "MEM%", "NAME");
+    mvwprintw(ui.processes.win, 1, 2, "%-6s %6s %6s ", "PID", "CPU%", "MEM%");
+    if (proc_view.show_mem) wprintw(ui.processes.win, "%7s %7s %7s  ", "PSS", "USS", "SWAP");
+    if (show_net) wprintw(ui.processes.win, "%5s %9s %9s ", "SOCK", "RX KB/s", "TX KB/s");
+    if (show_io) wprintw(ui.processes.win, "%9s %9s %7s %7s ", "RD KB/s", "WR KB/s", "RDSC/s", "WRSC/s");
+    wprintw(ui.processes.win, "%s", "NAME");
 
-    int max_rows = ui.processes.height - 3;
-    int to_show = metrics->count > max_rows ? max_rows : metrics->count;
+    const process_info_t *shown[PROCESS_VISIBLE_MAX];
+    int shown_count = 0;
+
+    int name_end = ui.dim.max_x - 2;
     int row = 2;
+    for (int i = first; i < last; i++) {
+        const process_info_t *p;
+        if (i < sorted) {
+            p = &metrics->processes[i];
+        } else if (have_tail) {
+            p = proc_view.tail[i - sorted];
+        } else {
+            break;
+        }
+        if (shown_count < PROCESS_VISIBLE_MAX) shown[shown_count++] = p;
+
+        mvwprintw(ui.processes.win, row, 2, "%-6d %6.1f %6.1f ",
+                  p->pid, p->cpu_usage, p->mem_usage);
+        if (proc_view.show_mem) draw_process_memory(p);
+        if (show_net) {
+            wprintw(ui.processes.win, "%5u %9.1f %9.1f ",
+                    p->sockets, p->net_rx_rate, p->net_tx_rate);
+        }
+        if (show_io) {
+            if (p->io_available) {
+                wprintw(ui.processes.win, "%9.1f %9.1f %7.0f %7.0f ", p->io_read_rate,
+                        p->io_write_rate, p->syscr_rate, p->syscw_rate);
+            } else {
+                wprintw(ui.processes.win, "%9s %9s %7s %7s ", "-", "-", "-", "-");
+            }
+        }
+
+        // Cut the name at the border instead of wrapping onto the next row
+        int x = getcurx(ui.processes.win);
+        wprintw(ui.processes.win, "%.*s", name_end > x ? name_end - x : 0, p->name);
+        row++;
+    }
+
+    // The collector reads smaps_rollup for these rows on its next scans
+    if (proc_view.show_mem) process_collector_set_visible(shown, shown_count);
+}
+
+// Format "addr:port" of one endpoint, IPv6 addresses in brackets
+static void format_endpoint(char *buf, size_t size, int family, const uint8_t *addr, int port)
+{
+    char host[INET6_ADDRSTRLEN];
+    if (!inet_ntop(family, addr, host, sizeof(host))) {
+        snprintf(host, sizeof(host), "?");
+    }
+    snprintf(buf, size, family == AF_INET6 ? "[%s]:%d" : "%s:%d", host, port);
+}
+
+// Update TCP connection display
+void ui_update_connections(const connection_metrics_t *metrics)
+{
+    if (!metrics || !ui.connections.win) return;
 
-    // Show active processes first (CPU% > 0)
-    for (int i = 0; i < to_show; i++) {
-        if (metrics->processes[i].cpu_usage >= 0.0) {  // Threshold
-            mvwprintw(ui.processes.win, row++, 2, "%-6d %6.1f %6.1f %-20s",
-                     metrics->processes[i].pid,
-                     metrics->processes[i].cpu_usage,
-                     metrics->processes[i].mem_usage,
-                     metrics->processes[i].name);
+    werase(ui.connections.win);
+    box(ui.connections.win, 0, 0);
+
+    if (!metrics->available) {
+        mvwprintw(ui.connections.win, 0, 2, " Connections ");
+        mvwprintw(ui.connections.win, 1, 2, "Socket diagnostics unavailable");
+        return;
+    }
+
+    mvwprintw(ui.connections.win, 0, 2, " Connections (TCP %u, UDP %u) ",
+              metrics->tcp_count, metrics->udp_count);
+    mvwprintw(ui.connections.win, 1, 2, "%-10s %-30s %-30s %9s %9s %8s %7s",
+              "STATE", "LOCAL", "REMOTE", "RX KB/s", "TX KB/s", "RTT ms", "RETR/s");
+
+    int max_rows = ui.connections.height - 3;
+    for (int i = 0; i < metrics->count && i < max_rows; i++) {
+        const connection_info_t *c = &metrics->top[i];
+        char local[64], remote[64];
+        format_endpoint(local, sizeof(local), c->family, c->local_addr, c->local_port);
+        format_endpoint(remote, sizeof(remote), c->family, c->remote_addr, c->remote_port);
+
+        mvwprintw(ui.connections.win, 2 + i, 2, "%-10s %-30.30s %-30.30s %9.1f %9.1f %8.2f %7.1f",
+                  socket_state_name(c->state), local, remote,
+                  c->rx_rate, c->tx_rate, c->rtt_us / 1000.0, c->retrans_rate);
+    }
+}
+
+// Update filesystem usage display
+void ui_update_filesystems(const filesystem_metrics_t *metrics)
+{
+    if (!metrics || !ui.filesystems.win) return;
+
+    WINDOW *win = ui.filesystems.win;
+    werase(win);
+    box(win, 0, 0);
+    mvwprintw(win, 0, 2, " Filesystems (%d) ", metrics->count);
+
+    // Two usage bars share the width left after the text columns
+    const int text_width = 24 + 1 + 8 + 1 + 7 + 1 + 7 + 1 + 7 + 1;
+    const int pct_width = 7;
+    int bar_width = (ui.dim.bar_width - text_width - 2 * pct_width - 1) / 2;
+    if (bar_width < 0) bar_width = 0;
+    int inode_x = 2 + text_width + pct_width + bar_width + 1;
+
+    mvwprintw(win, 1, 2, "%-24s %-8s %7s %7s %7s ", "MOUNT", "TYPE", "SIZE", "USED", "AVAIL");
+    mvwprintw(win, 1, 2 + text_width, "%6s", "USE%");
+    mvwprintw(win, 1, inode_x, "%6s", "INODE%");
+
+    int max_rows = ui.filesystems.height - 3;
+    for (int i = 0; i < metrics->count && i < max_rows; i++) {
+        const fs_mount_t *m = &metrics->mounts[i];
+        int y = 2 + i;
+        char size[16], used[16], avail[16];
+        format_size(size, sizeof(size), m->total);
+        format_size(used, sizeof(used), m->used);
+        format_size(avail, sizeof(avail), m->available);
+
+        mvwprintw(win, y, 2, "%-24.24s %-8.8s %7s %7s %7s ",
+                  m->mount_point, m->fstype, size, used, avail);
+        if (!m->responding) {
+            wprintw(win, "not responding");
+            continue;
         }
+
+        mvwprintw(win, y, 2 + text_width, "%5.1f%%", m->usage_percent);
+        draw_progress_bar(win, y, 2 + text_width + pct_width, bar_width, m->usage_percent,
+                          get_usage_color(m->usage_percent));
+
+        if (m->inodes_total == 0) {
+            mvwprintw(win, y, inode_x, "%6s", "-");
+            continue;
+        }
+        mvwprintw(win, y, inode_x, "%5.1f%%", m->inode_percent);
+        draw_progress_bar(win, y, inode_x + pct_width, bar_width, m->inode_percent,
+                          get_usage_color(m->inode_percent));
     }
+}
+
+// Update cgroup usage display
+void ui_update_cgroups(const cgroup_metrics_t *metrics)
+{
+    if (!metrics || !ui.cgroups.win) return;
+
+    WINDOW *win = ui.cgroups.win;
+    werase(win);
+    box(win, 0, 0);
 
-    // Separator if we have both active and idle
-    if (row > 2 && row < max_rows) {
-        mvwprintw(ui.processes.win, row++, 2, "--- Idle processes ---");
+    if (!metrics->available) {
+        mvwprintw(win, 0, 2, " Control Groups ");
+        mvwprintw(win, 1, 2, "No cgroup v2 hierarchy mounted");
+        return;
     }
 
-    // Show idle processes
-    for (int i = 0; i < to_show && row < max_rows; i++) {
-        if (metrics->processes[i].cpu_usage <= 0.1) {
-            mvwprintw(ui.processes.win, row++, 2, "%-6d %6.1f %6.1f %-20s",
-                     metrics->processes[i].pid,
-                     metrics->processes[i].cpu_usage,
-                     metrics->processes[i].mem_usage,
-                     metrics->processes[i].name);
+    mvwprintw(win, 0, 2, " Control Groups (%d tracked, by CPU) ", metrics->total);
+    mvwprintw(win, 1, 2, "%6s %6s %7s %7s %7s %9s %9s %5s %5s %5s %s",
+              "CPU%", "THR%", "MEM", "ANON", "FILE", "RD KB/s", "WR KB/s",
+              "PSI-C", "PSI-M", "PSI-I", "PATH");
+
+    int max_rows = ui.cgroups.height - 3;
+    int path_end = ui.dim.max_x - 2;
+    for (int i = 0; i < metrics->count && i < max_rows; i++) {
+        const cgroup_info_t *c = &metrics->top[i];
+        mvwprintw(win, 2 + i, 2, "%6.1f %6.1f ", c->cpu_usage, c->throttled_pct);
+
+        if (c->has_memory) {
+            char mem[16], anon[16], file[16];
+            format_size(mem, sizeof(mem), c->mem_current);
+            format_size(anon, sizeof(anon), c->mem_anon);
+            format_size(file, sizeof(file), c->mem_file);
+            wprintw(win, "%7s %7s %7s ", mem, anon, file);
+        } else {
+            wprintw(win, "%7s %7s %7s ", "-", "-", "-");
+        }
+        if (c->has_io) {
+            wprintw(win, "%9.1f %9.1f ", c->io_read_rate, c->io_write_rate);
+        } else {
+            wprintw(win, "%9s %9s ", "-", "-");
+        }
+        if (c->has_pressure) {
+            wprintw(win, "%5.1f %5.1f %5.1f ", c->psi_cpu, c->psi_memory, c->psi_io);
+        } else {
+            wprintw(win, "%5s %5s %5s ", "-", "-", "-");
+        }
+
+        // Container IDs sit at the end of the path, so a long one loses its start
+        int room = path_end - getcurx(win);
+        int len = (int)strlen(c->path);
+        if (room <= 0) continue;
+        if (len > room && room > 3) {
+            wprintw(win, "...%s", c->path + len - (room - 3));
+        } else {
+            wprintw(win, "%.*s", room, c->path);
         }
     }
 }
 
 // Handle user input
-void ui_handle_input(void) 
+bool ui_handle_input(void) 
 {
-    int ch = getch();
-    if (ch == 'q' || ch == 'Q') {
-        kill(getpid(), SIGTERM);
+    int ch;
+    int page = ui.processes.height - 3;
+    int scroll = proc_view.scroll;
+    process_sort_t sort = proc_view.sort;
+    bool show_mem = proc_view.show_mem;
+    cpu_sort_t cpu_sort = cpu_view.sort;
+    mem_view_t view = mem_view;
+
+    // Drain everything ncurses has buffered; epoll will not report it again
+    while ((ch = getch()) != ERR) {
+        switch (ch) {
+            case 'q':
+            case 'Q':
+                kill(getpid(), SIGTERM);
+                break;
+            case KEY_UP:    proc_view.scroll--; break;
+            case KEY_DOWN:  proc_view.scroll++; break;
+            case KEY_PPAGE: proc_view.scroll -= page; break;
+            case KEY_NPAGE: proc_view.scroll += page; break;
+            case KEY_HOME:  proc_view.scroll = 0; break;
+            case KEY_END:   proc_view.scroll = INT_MAX / 2; break;
+            case 'c':
+            case 'C':
+                proc_view.sort = PROCESS_SORT_CPU;
+                break;
+            case 'i':
+            case 'I':
+                proc_view.sort = PROCESS_SORT_IO;
+                break;
+            case 'm':
+            case 'M':
+                proc_view.show_mem = !proc_view.show_mem;
+                break;
+            case 's':
+            case 'S':
+                cpu_view.sort = cpu_view.sort == CPU_SORT_STEAL ? CPU_SORT_ID : CPU_SORT_STEAL;
+                break;
+            case 'w':
+            case 'W':
+                cpu_view.sort = cpu_view.sort == CPU_SORT_IOWAIT ? CPU_SORT_ID : CPU_SORT_IOWAIT;
+                break;
+            case 'p':
+            case 'P':
+                mem_view = (mem_view + 1) % MEM_VIEW_COUNT;
+                break;
+        }
+    }
+
+    // Stop the smaps_rollup reads as soon as the columns are hidden
+    if (proc_view.show_mem != show_mem && !proc_view.show_mem) {
+        process_collector_set_visible(NULL, 0);
     }
+
+    // The collector picks the order up on its next scan; until then the
+    // panel orders the rows itself
+    if (proc_view.sort != sort) {
+        process_collector_set_sort(proc_view.sort);
+        proc_view.scroll = 0;
+    }
+
+    // Clamped against the process count on the next redraw
+    if (proc_view.scroll < 0) proc_view.scroll = 0;
+    return proc_view.scroll != scroll || proc_view.sort != sort ||
+           proc_view.show_mem != show_mem || cpu_view.sort != cpu_sort || mem_view != view;
 }
 
 // Refresh the display
 void ui_refresh(void) 
 {
-    wrefresh(ui.header.win);
-    wrefresh(ui.cpu.win);
-    wrefresh(ui.memory.win);
-    wrefresh(ui.network.win);
-    wrefresh(ui.disk.win);
-    wrefresh(ui.processes.win);
-    wrefresh(ui.footer.win);
-    refresh();
+    wnoutrefresh(stdscr);
+    if (ui.header.win) wnoutrefresh(ui.header.win);
+    for (size_t i = 0; i < NUM_PANELS; i++) {
+        if (panel_layout[i].layout->win) wnoutrefresh(panel_layout[i].layout->win);
+    }
+    if (ui.footer.win) wnoutrefresh(ui.footer.win);
+    doupdate();
 }
 
 // Clean up UI resources
 void ui_cleanup(void) 
 {
-    if (ui.header.win) delwin(ui.header.win);
-    if (ui.cpu.win) delwin(ui.cpu.win);
-    if (ui.memory.win) delwin(ui.memory.win);
-    if (ui.network.win) delwin(ui.network.win);
-    if (ui.disk.win) delwin(ui.disk.win);
-    if (ui.processes.win) delwin(ui.processes.win);
-    if (ui.footer.win) delwin(ui.footer.win);
+    destroy_windows();
     endwin();
+
+    free(cpu_view.order);
+    cpu_view.order = NULL;
+    cpu_view.order_capacity = 0;
+
+    free(proc_view.tail);
+    proc_view.tail = NULL;
+    proc_view.tail_capacity = 0;
+    proc_view.tail_base = NULL;
 }
 
 // Handle window resize events
 void ui_handle_resize(void)
 {
-    // Block SIGWINCH during resize
-    sigset_t mask, oldmask;
-    sigemptyset(&mask);
-    sigaddset(&mask, SIGWINCH);
-    sigprocmask(SIG_BLOCK, &mask, &oldmask);
+    // SIGWINCH stays blocked for the whole run (main.c reads it from a
+    // signalfd), so no further resize can interrupt this one
 
     // Reinitialize ncurses to handle resizing
     endwin();
@@ -375,7 +1139,6 @@ void ui_handle_resize(void)
     getmaxyx(stdscr, ui.dim.max_y, ui.dim.max_x);
     if (ui.dim.max_y <= 0 || ui.dim.max_x <= 0) {
         log_error("Invalid terminal dimensions: %d x %d", ui.dim.max_y, ui.dim.max_x);
-        sigprocmask(SIG_UNBLOCK, &mask, NULL);
         return;
     }
     ui.dim.bar_width = ui.dim.max_x - 4;
@@ -383,40 +1146,13 @@ void ui_handle_resize(void)
     // Log the new dimensions for debugging
     log_info("Resizing UI: new dimensions = %d x %d", ui.dim.max_y, ui.dim.max_x);
 
-    // Delete old windows
-    if (ui.header.win) delwin(ui.header.win);
-    if (ui.cpu.win) delwin(ui.cpu.win);
-    if (ui.memory.win) delwin(ui.memory.win);
-    if (ui.network.win) delwin(ui.network.win);
-    if (ui.disk.win) delwin(ui.disk.win);
-    if (ui.processes.win) delwin(ui.processes.win);
-    if (ui.footer.win) delwin(ui.footer.win);
-
     // Recreate windows with updated dimensions
-    if (!init_window(&ui.header, 3, 0, NULL) ||
-        !init_window(&ui.cpu, 7, 3, "CPU Usage") ||
-        !init_window(&ui.memory, 7, 10, "Memory Usage") ||
-        !init_window(&ui.network, 7, 17, "Network Activity") ||
-        !init_window(&ui.disk, 7, 24, "Disk I/O") ||
-        !init_window(&ui.processes, 13, 31, "Processes") || 
-        !init_window(&ui.footer, 3, ui.dim.max_y - 3, NULL)) {
+    destroy_windows();
+    if (!create_windows()) {
         log_error("Failed to resize UI");
-        sigprocmask(SIG_UNBLOCK, &mask, NULL);
         return;
     }
 
-    // Redraw header and footer
-    wattron(ui.header.win, ui.attr.header);
-    mvwprintw(ui.header.win, 1, (ui.dim.max_x - 15) / 2, "sysmon v%s", SYSMON_VERSION);
-    wattroff(ui.header.win, ui.attr.header);
-
-    wattron(ui.footer.win, ui.attr.header);
-    mvwprintw(ui.footer.win, 1, 2, "q: Quit");
-    wattroff(ui.footer.win, ui.attr.header);
-
     // Refresh the UI
     ui_refresh();
-
-    // Unblock SIGWINCH
-    sigprocmask(SIG_UNBLOCK, &mask, NULL);
 }
\ No newline at end of file
@@ -18,6 +18,12 @@ void ui_update_cpu(const cpu_metrics_t *metrics);
 // Update memory display
 void ui_update_memory(const memory_metrics_t *metrics);
 
+// Update pressure stall display
+void ui_update_pressure(const psi_metrics_t *metrics);
+
+// Update paging and reclaim display
+void ui_update_vmstat(const vmstat_metrics_t *metrics);
+
 // Update network display
 void ui_update_network(const network_metrics_t *metrics);
 
@@ -27,11 +33,20 @@ void ui_update_disk(const disk_metrics_t *metrics);
 // Update process display
 void ui_update_processes(const process_metrics_t *metrics);
 
+// Update TCP connection display
+void ui_update_connections(const connection_metrics_t *metrics);
+
+// Update filesystem usage display
+void ui_update_filesystems(const filesystem_metrics_t *metrics);
+
+// Update cgroup usage display
+void ui_update_cgroups(const cgroup_metrics_t *metrics);
+
 // window resize handler
 void ui_handle_resize(void);
 
-// Handle user input
-void ui_handle_input(void);
+// Handle user input; returns true when the display needs redrawing
+bool ui_handle_input(void);
 
 // Refresh the display
 void ui_refresh(void);
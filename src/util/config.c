@@ -0,0 +1,145 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * config.c - Configuration file implementation
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "config.h"
+#include "error_handler.h"
+
+// Parsed configuration entries
+static struct {
+    char key[MAX_CONFIG_KEY];
+    char value[MAX_CONFIG_VALUE];
+} entries[MAX_CONFIG_ENTRIES];
+
+static int num_entries = 0;
+
+// Strip leading and trailing whitespace in place
+static char *trim(char *str)
+{
+    while (isspace((unsigned char)*str)) str++;
+
+    char *end = str + strlen(str);
+    while (end > str && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return str;
+}
+
+bool config_load(const char *path)
+{
+    num_entries = 0;
+
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        if (errno == ENOENT) {
+            log_info("No configuration file at %s, using defaults", path);
+            return true;
+        }
+        log_error("Failed to open %s", path);
+        return false;
+    }
+
+    char line[MAX_CONFIG_KEY + MAX_CONFIG_VALUE];
+    int line_no = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char *text = trim(line);
+        if (*text == '\0') continue;
+
+        char *eq = strchr(text, '=');
+        if (!eq) {
+            log_warning("%s:%d: expected key = value", path, line_no);
+            continue;
+        }
+        *eq = '\0';
+
+        char *key = trim(text);
+        char *value = trim(eq + 1);
+        if (strlen(key) >= MAX_CONFIG_KEY || strlen(value) >= MAX_CONFIG_VALUE) {
+            log_warning("%s:%d: entry too long", path, line_no);
+            continue;
+        }
+        if (num_entries >= MAX_CONFIG_ENTRIES) {
+            log_warning("%s: more than %d entries, ignoring the rest", path, MAX_CONFIG_ENTRIES);
+            break;
+        }
+
+        strcpy(entries[num_entries].key, key);
+        strcpy(entries[num_entries].value, value);
+        num_entries++;
+    }
+    fclose(fp);
+
+    log_info("Loaded %d configuration entries from %s", num_entries, path);
+    return true;
+}
+
+const char *config_get_string(const char *key, const char *def)
+{
+    // Later entries override earlier ones
+    for (int i = num_entries - 1; i >= 0; i--) {
+        if (strcmp(entries[i].key, key) == 0) {
+            return entries[i].value;
+        }
+    }
+    return def;
+}
+
+double config_get_double(const char *key, double def)
+{
+    const char *value = config_get_string(key, NULL);
+    if (!value) return def;
+
+    char *end;
+    double result = strtod(value, &end);
+    if (end == value || *end != '\0') {
+        log_warning("Invalid number for %s: %s", key, value);
+        return def;
+    }
+    return result;
+}
+
+long config_get_long(const char *key, long def)
+{
+    const char *value = config_get_string(key, NULL);
+    if (!value) return def;
+
+    char *end;
+    long result = strtol(value, &end, 10);
+    if (end == value || *end != '\0') {
+        log_warning("Invalid integer for %s: %s", key, value);
+        return def;
+    }
+    return result;
+}
+
+bool config_get_bool(const char *key, bool def)
+{
+    const char *value = config_get_string(key, NULL);
+    if (!value) return def;
+
+    if (strcasecmp(value, "true") == 0 || strcasecmp(value, "yes") == 0 ||
+        strcasecmp(value, "on") == 0 || strcmp(value, "1") == 0) {
+        return true;
+    }
+    if (strcasecmp(value, "false") == 0 || strcasecmp(value, "no") == 0 ||
+        strcasecmp(value, "off") == 0 || strcmp(value, "0") == 0) {
+        return false;
+    }
+    log_warning("Invalid boolean for %s: %s", key, value);
+    return def;
+}
@@ -0,0 +1,32 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * config.h - Configuration file interface
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "../include/sysmon.h"
+
+#define CONFIG_DEFAULT_PATH "config/sysmon.conf"
+#define MAX_CONFIG_ENTRIES 64
+#define MAX_CONFIG_KEY 64
+#define MAX_CONFIG_VALUE 256
+
+// Load "key = value" pairs from a file; a missing file is not an error
+bool config_load(const char *path);
+
+// Look up a string value, or def if the key is absent
+const char *config_get_string(const char *key, const char *def);
+
+// Look up a numeric value, or def if the key is absent or malformed
+double config_get_double(const char *key, double def);
+
+// Look up an integer value, or def if the key is absent or malformed
+long config_get_long(const char *key, long def);
+
+// Look up a boolean value (true/false, yes/no, on/off, 1/0)
+bool config_get_bool(const char *key, bool def);
+
+#endif /* CONFIG_H */
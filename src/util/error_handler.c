@@ -63,7 +63,7 @@ void log_message(log_level_t level, const char *format, ...)
 {
     va_list args;
     va_start(args, format);
-    logger_log(level, format, args);
+    logger_vlog(level, format, args);
     va_end(args);
 
     // Exit on fatal errors
@@ -77,21 +77,21 @@ void log_message(log_level_t level, const char *format, ...)
 void log_error(const char *format, ...) {
     va_list args;
     va_start(args, format);
-    logger_log(LOG_ERROR, format, args);
+    logger_vlog(LOG_ERROR, format, args);
     va_end(args);
 }
 
 void log_warning(const char *format, ...) {
     va_list args;
     va_start(args, format);
-    logger_log(LOG_WARNING, format, args);
+    logger_vlog(LOG_WARNING, format, args);
     va_end(args);
 }
  
 void log_info(const char *format, ...) {
     va_list args;
     va_start(args, format);
-    logger_log(LOG_INFO, format, args);
+    logger_vlog(LOG_INFO, format, args);
     va_end(args);
 }
  
@@ -0,0 +1,161 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * hash_table.c - Open-addressing hash table implementation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_table.h"
+#include "error_handler.h"
+
+// Rehash once live entries plus tombstones fill 70% of the slots
+#define MAX_LOAD_NUM 7
+#define MAX_LOAD_DEN 10
+
+// Shrink when fewer than one slot in eight is live
+#define MIN_LOAD_DIV 8
+
+static size_t round_up_pow2(size_t n)
+{
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+static hash_slot_t *header(const hash_table_t *table, size_t i)
+{
+    return (hash_slot_t *)hash_table_slot(table, i);
+}
+
+bool hash_table_init(hash_table_t *table, size_t entry_size, size_t capacity)
+{
+    table->entry_size = entry_size;
+    table->capacity = round_up_pow2(capacity < 16 ? 16 : capacity);
+    table->slots = calloc(table->capacity, entry_size);
+    table->live = 0;
+    table->tombstones = 0;
+
+    if (!table->slots) {
+        log_error("Memory allocation failed");
+        table->capacity = 0;
+        return false;
+    }
+    return true;
+}
+
+void hash_table_free(hash_table_t *table)
+{
+    free(table->slots);
+    table->slots = NULL;
+    table->capacity = 0;
+    table->live = 0;
+    table->tombstones = 0;
+}
+
+// Move live entries into a fresh slot array, dropping tombstones
+static bool rehash(hash_table_t *table, size_t capacity)
+{
+    unsigned char *slots = calloc(capacity, table->entry_size);
+    if (!slots) {
+        log_error("Memory allocation failed");
+        return false;
+    }
+
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < table->capacity; i++) {
+        const hash_slot_t *e = header(table, i);
+        if (e->state != HASH_SLOT_LIVE) continue;
+
+        size_t j = e->hash & mask;
+        while (((hash_slot_t *)(slots + j * table->entry_size))->state != HASH_SLOT_EMPTY) {
+            j = (j + 1) & mask;
+        }
+        memcpy(slots + j * table->entry_size, e, table->entry_size);
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    table->tombstones = 0;
+    return true;
+}
+
+void *hash_table_find(const hash_table_t *table, uint32_t hash, hash_eq_fn eq, const void *key)
+{
+    if (table->capacity == 0) return NULL;
+
+    size_t mask = table->capacity - 1;
+    for (size_t i = hash & mask; header(table, i)->state != HASH_SLOT_EMPTY; i = (i + 1) & mask) {
+        hash_slot_t *e = header(table, i);
+        if (e->state == HASH_SLOT_LIVE && e->hash == hash && eq(e, key)) return e;
+    }
+    return NULL;
+}
+
+void *hash_table_upsert(hash_table_t *table, uint32_t hash, hash_eq_fn eq, const void *key,
+                        bool *inserted)
+{
+    if ((table->live + table->tombstones + 1) * MAX_LOAD_DEN >
+        table->capacity * MAX_LOAD_NUM) {
+        // Grow when live entries dominate, otherwise just clear tombstones
+        size_t capacity = table->capacity;
+        if ((table->live + 1) * 2 * MAX_LOAD_DEN > capacity * MAX_LOAD_NUM) {
+            capacity *= 2;
+        }
+        if (!rehash(table, capacity)) return NULL;
+    }
+
+    size_t mask = table->capacity - 1;
+    size_t i = hash & mask;
+    hash_slot_t *reuse = NULL;
+
+    for (;;) {
+        hash_slot_t *e = header(table, i);
+
+        if (e->state == HASH_SLOT_EMPTY) break;
+        if (e->state == HASH_SLOT_TOMBSTONE) {
+            if (!reuse) reuse = e;
+        } else if (e->hash == hash && eq(e, key)) {
+            *inserted = false;
+            return e;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // Not found: take the first tombstone on the probe path, else the empty slot
+    hash_slot_t *e = reuse ? reuse : header(table, i);
+    if (reuse) table->tombstones--;
+
+    memset(e, 0, table->entry_size);
+    e->hash = hash;
+    e->state = HASH_SLOT_LIVE;
+    table->live++;
+
+    *inserted = true;
+    return e;
+}
+
+void hash_table_remove(hash_table_t *table, void *entry)
+{
+    hash_slot_t *e = entry;
+    if (e->state != HASH_SLOT_LIVE) return;
+
+    e->state = HASH_SLOT_TOMBSTONE;
+    table->live--;
+    table->tombstones++;
+}
+
+void hash_table_shrink(hash_table_t *table, size_t min_capacity)
+{
+    if (table->capacity <= min_capacity || table->live * MIN_LOAD_DIV >= table->capacity) {
+        return;
+    }
+
+    size_t capacity = table->capacity;
+    while (capacity > min_capacity && table->live * MIN_LOAD_DIV < capacity / 2) {
+        capacity /= 2;
+    }
+    rehash(table, capacity);
+}
@@ -0,0 +1,66 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * hash_table.h - Open-addressing hash table for the persistent tables
+ */
+
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    HASH_SLOT_EMPTY = 0,
+    HASH_SLOT_LIVE,
+    HASH_SLOT_TOMBSTONE             // Entry removed; slot reusable, probe continues
+} hash_slot_state_t;
+
+// Header every entry type starts with
+typedef struct {
+    uint32_t hash;                  // Hash of the entry's key, kept for rehashing and fast compares
+    hash_slot_state_t state;
+} hash_slot_t;
+
+// True if a live entry holds key; only called for entries with a matching hash
+typedef bool (*hash_eq_fn)(const void *entry, const void *key);
+
+// Linear probing over fixed-size entries. Live entries and tombstones
+// never fill more than 70% of the slots.
+typedef struct {
+    unsigned char *slots;
+    size_t entry_size;              // Size of one entry, header included
+    size_t capacity;                // Always a power of two
+    size_t live;                    // Slots holding an entry
+    size_t tombstones;              // Slots of removed entries
+} hash_table_t;
+
+// Allocate a table of entry_size entries with at least capacity slots
+bool hash_table_init(hash_table_t *table, size_t entry_size, size_t capacity);
+
+// Release table storage
+void hash_table_free(hash_table_t *table);
+
+// Entry in slot i, whatever its state
+static inline void *hash_table_slot(const hash_table_t *table, size_t i)
+{
+    return table->slots + i * table->entry_size;
+}
+
+// Live entry holding key, or NULL
+void *hash_table_find(const hash_table_t *table, uint32_t hash, hash_eq_fn eq, const void *key);
+
+// Find the entry holding key, or insert a zeroed one with its header set.
+// *inserted tells which. Entry pointers stay valid until the next upsert.
+void *hash_table_upsert(hash_table_t *table, uint32_t hash, hash_eq_fn eq, const void *key,
+                        bool *inserted);
+
+// Tombstone a live entry
+void hash_table_remove(hash_table_t *table, void *entry);
+
+// Halve the table while fewer than one slot in eight would be live,
+// down to min_capacity, after a large drop in entries
+void hash_table_shrink(hash_table_t *table, size_t min_capacity);
+
+#endif /* HASH_TABLE_H */
@@ -4,6 +4,7 @@
  * logger.c - Thread-safe logging implementation
  */
 
+ #define _POSIX_C_SOURCE 200809L
  #include <stdio.h>
  #include <stdlib.h>
  #include <stdarg.h>
@@ -40,15 +41,14 @@ bool logger_init(const char *filename) {
     return true;
 }
 
-void logger_log(log_level_t level, const char *format, ...) {
+void logger_vlog(log_level_t level, const char *format, va_list args) {
     if (!log_stream) return;
 
     time_t now = time(NULL);
+    struct tm tm_now;
     char timestamp[20];
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
-
-    va_list args;
-    va_start(args, format);
+    localtime_r(&now, &tm_now);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm_now);
 
     // First print to our buffer to get the length
     char message[1024];
@@ -57,7 +57,12 @@ void logger_log(log_level_t level, const char *format, ...) {
     fprintf(log_stream, "[%s] [%5s] %s\n", 
             timestamp, log_level_to_str(level), message);
     fflush(log_stream);
+}
 
+void logger_log(log_level_t level, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    logger_vlog(level, format, args);
     va_end(args);
 }
 
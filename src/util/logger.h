@@ -7,6 +7,8 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <stdarg.h>
+
 #include "../include/sysmon.h"  // For log_level_t
  
 // Initialize logger with output file
@@ -15,6 +17,9 @@ bool logger_init(const char *filename);
 // Thread-safe logging function
 void logger_log(log_level_t level, const char *format, ...);
 
+// Same as logger_log() for callers that already hold a va_list
+void logger_vlog(log_level_t level, const char *format, va_list args);
+
 // Clean up logger resources 
 void logger_cleanup(void);
 
@@ -0,0 +1,90 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * netlink.c - Netlink request/dump helper
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "netlink.h"
+
+bool nl_socket_open(nl_socket_t *sock, int protocol, size_t buf_size)
+{
+    sock->seq = 0;
+    sock->buf = NULL;
+    sock->buf_size = buf_size;
+
+    sock->fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, protocol);
+    if (sock->fd == -1) return false;
+
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK };
+    sock->buf = malloc(buf_size);
+    if (!sock->buf || bind(sock->fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        int saved = errno;
+        nl_socket_close(sock);
+        errno = saved;
+        return false;
+    }
+    return true;
+}
+
+void nl_socket_close(nl_socket_t *sock)
+{
+    if (sock->fd != -1) close(sock->fd);
+    sock->fd = -1;
+    free(sock->buf);
+    sock->buf = NULL;
+}
+
+// Send a dump request whose header is followed by len bytes of body
+static bool send_request(nl_socket_t *sock, uint16_t type, const void *body, size_t len)
+{
+    _Alignas(struct nlmsghdr) char req[NLMSG_SPACE(NETLINK_MAX_BODY)];
+    if (len > NETLINK_MAX_BODY) return false;
+    memset(req, 0, sizeof(req));
+
+    struct nlmsghdr *nlh = (struct nlmsghdr *)req;
+    nlh->nlmsg_len = NLMSG_LENGTH(len);
+    nlh->nlmsg_type = type;
+    nlh->nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    nlh->nlmsg_seq = ++sock->seq;
+    memcpy(NLMSG_DATA(nlh), body, len);
+
+    struct sockaddr_nl kernel = { .nl_family = AF_NETLINK };
+    return sendto(sock->fd, req, nlh->nlmsg_len, 0,
+                  (struct sockaddr *)&kernel, sizeof(kernel)) == (ssize_t)nlh->nlmsg_len;
+}
+
+int nl_dump(nl_socket_t *sock, uint16_t type, const void *body, size_t len,
+            uint16_t reply_type, nl_msg_fn fn, void *ctx)
+{
+    if (sock->fd == -1) return EBADF;
+    if (!send_request(sock, type, body, len)) return errno ? errno : EINVAL;
+
+    for (;;) {
+        ssize_t n = recv(sock->fd, sock->buf, sock->buf_size, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+
+        size_t left = (size_t)n;
+        for (const struct nlmsghdr *nlh = (const struct nlmsghdr *)sock->buf;
+             NLMSG_OK(nlh, left); nlh = NLMSG_NEXT(nlh, left)) {
+            // Leftovers from an earlier, abandoned dump
+            if (nlh->nlmsg_seq != sock->seq) continue;
+
+            if (nlh->nlmsg_type == NLMSG_DONE) return 0;
+            if (nlh->nlmsg_type == NLMSG_ERROR) {
+                const struct nlmsgerr *e = NLMSG_DATA(nlh);
+                return e->error ? -e->error : EIO;
+            }
+            if (nlh->nlmsg_type == reply_type) fn(nlh, ctx);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * netlink.h - Netlink request/dump helper
+ */
+
+#ifndef NETLINK_H
+#define NETLINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/netlink.h>
+
+#define NETLINK_RECV_BUF (64 * 1024)   // Large enough for the kernel to pack many replies
+#define NETLINK_MAX_BODY 128           // Largest request body nl_dump() sends
+
+// A netlink socket used for dump requests
+typedef struct {
+    int fd;
+    uint32_t seq;                   // Sequence number of the current request
+    char *buf;                      // Receive buffer, aligned by malloc
+    size_t buf_size;
+} nl_socket_t;
+
+// Called for every reply message of the requested type
+typedef void (*nl_msg_fn)(const struct nlmsghdr *nlh, void *ctx);
+
+// Open and bind a socket for the given NETLINK_* protocol
+bool nl_socket_open(nl_socket_t *sock, int protocol, size_t buf_size);
+
+// Close the socket and free its buffer
+void nl_socket_close(nl_socket_t *sock);
+
+// Send an NLM_F_DUMP request of the given type with len bytes of body and
+// hand every reply of reply_type to fn until NLMSG_DONE. Returns 0, or
+// the errno reported by the kernel or the socket.
+int nl_dump(nl_socket_t *sock, uint16_t type, const void *body, size_t len,
+            uint16_t reply_type, nl_msg_fn fn, void *ctx);
+
+#endif /* NETLINK_H */
@@ -0,0 +1,166 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * procfs_parse.c - Buffered procfs reader and zero-copy tokenizer
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "procfs_parse.h"
+
+bool procfs_buf_init(procfs_buf_t *buf, size_t capacity)
+{
+    buf->data = malloc(capacity);
+    buf->len = 0;
+    buf->capacity = buf->data ? capacity : 0;
+    return buf->data != NULL;
+}
+
+void procfs_buf_free(procfs_buf_t *buf)
+{
+    free(buf->data);
+    buf->data = NULL;
+    buf->len = 0;
+    buf->capacity = 0;
+}
+
+bool procfs_file_open(procfs_file_t *file, const char *path)
+{
+    file->path = path;
+    file->fd = open(path, O_RDONLY | O_CLOEXEC);
+    return file->fd != -1;
+}
+
+void procfs_file_close(procfs_file_t *file)
+{
+    if (file->fd != -1) close(file->fd);
+    file->fd = -1;
+}
+
+bool procfs_read_fd(int fd, procfs_buf_t *buf)
+{
+    // seq_file hands out at most one page of records per read, so keep
+    // reading until EOF. Continuing at the offset just returned lets the
+    // kernel resume where it stopped instead of walking from the start.
+    size_t len = 0;
+
+    for (;;) {
+        if (len == buf->capacity - 1) {
+            char *bigger = realloc(buf->data, buf->capacity * 2);
+            if (!bigger) return false;
+            buf->data = bigger;
+            buf->capacity *= 2;
+        }
+
+        ssize_t n = pread(fd, buf->data + len, buf->capacity - 1 - len, (off_t)len);
+        if (n < 0) return false;
+        if (n == 0) break;
+        len += (size_t)n;
+    }
+
+    buf->len = len;
+    buf->data[len] = '\0';
+    return true;
+}
+
+bool procfs_read_fd_single(int fd, procfs_buf_t *buf)
+{
+    // The file is generated in one piece on a read at offset 0, so a
+    // short read means we got everything; a full buffer means grow and retry
+    for (;;) {
+        ssize_t n = pread(fd, buf->data, buf->capacity - 1, 0);
+        if (n < 0) return false;
+
+        if ((size_t)n < buf->capacity - 1) {
+            buf->len = (size_t)n;
+            buf->data[n] = '\0';
+            return true;
+        }
+
+        char *bigger = realloc(buf->data, buf->capacity * 2);
+        if (!bigger) return false;
+        buf->data = bigger;
+        buf->capacity *= 2;
+    }
+}
+
+bool procfs_file_read(procfs_file_t *file, procfs_buf_t *buf)
+{
+    return file->fd != -1 && procfs_read_fd(file->fd, buf);
+}
+
+bool procfs_read_path(const char *path, procfs_buf_t *buf)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+
+    bool ok = procfs_read_fd(fd, buf);
+    close(fd);
+    return ok;
+}
+
+bool procfs_next_token(procfs_cursor_t *cur, const char **tok, size_t *len)
+{
+    procfs_skip_blanks(cur);
+    if (cur->p >= cur->end) return false;
+
+    const char *start = cur->p;
+    while (cur->p < cur->end && *cur->p != ' ' && *cur->p != '\t') cur->p++;
+
+    *tok = start;
+    *len = (size_t)(cur->p - start);
+    return true;
+}
+
+bool procfs_skip_fields(procfs_cursor_t *cur, unsigned int n)
+{
+    const char *p = cur->p;
+    const char *end = cur->end;
+    unsigned int remaining = n + 1;   // Field starts to find, counting the current one
+    unsigned int prev_blank = 1;      // The cursor position counts as a field start
+
+#ifdef __SSE2__
+    // Classify 16 bytes at a time: a field starts at a non-blank byte whose
+    // predecessor is blank, so whole runs of fields are counted by popcount
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        __m128i blanks = _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                      _mm_cmpeq_epi8(chunk, tab));
+        unsigned int blank = (unsigned int)_mm_movemask_epi8(blanks);
+        unsigned int starts = ~blank & ((blank << 1) | prev_blank) & 0xFFFFu;
+        unsigned int count = (unsigned int)__builtin_popcount(starts);
+
+        if (count >= remaining) {
+            while (--remaining) starts &= starts - 1;
+            cur->p = p + __builtin_ctz(starts);
+            return true;
+        }
+
+        remaining -= count;
+        prev_blank = (blank >> 15) & 1u;
+        p += 16;
+    }
+#endif
+
+    for (; p < end; p++) {
+        unsigned int blank = (*p == ' ' || *p == '\t');
+        if (!blank && prev_blank && --remaining == 0) {
+            cur->p = p;
+            return true;
+        }
+        prev_blank = blank;
+    }
+
+    cur->p = end;
+    return false;
+}
@@ -0,0 +1,135 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * procfs_parse.h - Buffered procfs reader and zero-copy tokenizer
+ */
+
+#ifndef PROCFS_PARSE_H
+#define PROCFS_PARSE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PROCFS_BUF_INITIAL 4096
+
+// Reusable read buffer; data is always NUL-terminated after a read
+typedef struct {
+    char *data;
+    size_t len;                 // Bytes of file content
+    size_t capacity;            // Allocated size
+} procfs_buf_t;
+
+// A procfs file kept open across ticks and re-read with pread
+typedef struct {
+    const char *path;
+    int fd;
+} procfs_file_t;
+
+// Read position inside a buffer; tokens point into the buffer, no copies
+typedef struct {
+    const char *p;
+    const char *end;
+} procfs_cursor_t;
+
+// Allocate a buffer with the given initial capacity
+bool procfs_buf_init(procfs_buf_t *buf, size_t capacity);
+
+// Release a buffer
+void procfs_buf_free(procfs_buf_t *buf);
+
+// Open a file for repeated reads
+bool procfs_file_open(procfs_file_t *file, const char *path);
+
+// Close a file opened with procfs_file_open()
+void procfs_file_close(procfs_file_t *file);
+
+// Re-read a whole open file from offset 0, growing the buffer as needed
+bool procfs_file_read(procfs_file_t *file, procfs_buf_t *buf);
+
+// Read a whole file from an already open descriptor with pread
+bool procfs_read_fd(int fd, procfs_buf_t *buf);
+
+// Like procfs_read_fd() for files the kernel produces in a single read
+// (e.g. /proc/[pid]/stat), saving the final zero-length read
+bool procfs_read_fd_single(int fd, procfs_buf_t *buf);
+
+// Open, read and close a file in one go (for short-lived per-PID files)
+bool procfs_read_path(const char *path, procfs_buf_t *buf);
+
+// Cursor over the content of a buffer
+static inline procfs_cursor_t procfs_cursor(const procfs_buf_t *buf)
+{
+    procfs_cursor_t cur = { buf->data, buf->data + buf->len };
+    return cur;
+}
+
+// Split off the next line (without '\n'); returns false at end of buffer
+static inline bool procfs_next_line(procfs_cursor_t *cur, procfs_cursor_t *line)
+{
+    if (cur->p >= cur->end) return false;
+
+    const char *eol = memchr(cur->p, '\n', (size_t)(cur->end - cur->p));
+    line->p = cur->p;
+    line->end = eol ? eol : cur->end;
+    cur->p = eol ? eol + 1 : cur->end;
+    return true;
+}
+
+// Skip spaces and tabs
+static inline void procfs_skip_blanks(procfs_cursor_t *cur)
+{
+    while (cur->p < cur->end && (*cur->p == ' ' || *cur->p == '\t')) cur->p++;
+}
+
+// Parse the next unsigned decimal, skipping leading blanks
+static inline bool procfs_parse_u64(procfs_cursor_t *cur, uint64_t *out)
+{
+    procfs_skip_blanks(cur);
+
+    const char *p = cur->p;
+    uint64_t value = 0;
+    while (p < cur->end && (unsigned)(*p - '0') < 10) {
+        value = value * 10 + (uint64_t)(*p - '0');
+        p++;
+    }
+    if (p == cur->p) return false;
+
+    cur->p = p;
+    *out = value;
+    return true;
+}
+
+// Parse the next signed decimal, skipping leading blanks
+static inline bool procfs_parse_i64(procfs_cursor_t *cur, int64_t *out)
+{
+    procfs_skip_blanks(cur);
+
+    bool negative = cur->p < cur->end && *cur->p == '-';
+    procfs_cursor_t digits = { cur->p + negative, cur->end };
+    uint64_t magnitude;
+    if (!procfs_parse_u64(&digits, &magnitude)) return false;
+
+    cur->p = digits.p;
+    *out = negative ? -(int64_t)magnitude : (int64_t)magnitude;
+    return true;
+}
+
+// Next blank-separated token; tok points into the buffer and is not NUL-terminated
+bool procfs_next_token(procfs_cursor_t *cur, const char **tok, size_t *len);
+
+// Skip n blank-separated fields, leaving the cursor at the start of the next one
+bool procfs_skip_fields(procfs_cursor_t *cur, unsigned int n);
+
+// True if the cursor starts with prefix; advances past it on a match
+static inline bool procfs_consume(procfs_cursor_t *cur, const char *prefix, size_t len)
+{
+    if ((size_t)(cur->end - cur->p) < len || memcmp(cur->p, prefix, len) != 0) {
+        return false;
+    }
+    cur->p += len;
+    return true;
+}
+
+#endif /* PROCFS_PARSE_H */
@@ -0,0 +1,117 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * scheduler.c - Deadline scheduler implementation (binary min-heap)
+ */
+
+#include "scheduler.h"
+#include "error_handler.h"
+
+static void heap_swap(scheduler_t *sched, size_t a, size_t b)
+{
+    sched_task_t *tmp = sched->heap[a];
+    sched->heap[a] = sched->heap[b];
+    sched->heap[b] = tmp;
+}
+
+static void sift_up(scheduler_t *sched, size_t i)
+{
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (sched->heap[parent]->deadline_ns <= sched->heap[i]->deadline_ns) break;
+        heap_swap(sched, parent, i);
+        i = parent;
+    }
+}
+
+static void sift_down(scheduler_t *sched, size_t i)
+{
+    for (;;) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t smallest = i;
+
+        if (left < sched->count &&
+            sched->heap[left]->deadline_ns < sched->heap[smallest]->deadline_ns) {
+            smallest = left;
+        }
+        if (right < sched->count &&
+            sched->heap[right]->deadline_ns < sched->heap[smallest]->deadline_ns) {
+            smallest = right;
+        }
+        if (smallest == i) break;
+
+        heap_swap(sched, i, smallest);
+        i = smallest;
+    }
+}
+
+static bool heap_push(scheduler_t *sched, sched_task_t *task)
+{
+    if (sched->count >= SCHED_MAX_TASKS) {
+        log_error("Scheduler is full, cannot add %s", task->name);
+        return false;
+    }
+    sched->heap[sched->count] = task;
+    sift_up(sched, sched->count++);
+    return true;
+}
+
+void scheduler_init(scheduler_t *sched)
+{
+    sched->count = 0;
+}
+
+bool scheduler_add(scheduler_t *sched, sched_task_t *task, uint64_t deadline_ns)
+{
+    if (task->period_ns == 0) {
+        log_error("Task %s has a zero period", task->name);
+        return false;
+    }
+    task->deadline_ns = deadline_ns;
+    task->last_run_ns = 0;
+    return heap_push(sched, task);
+}
+
+uint64_t scheduler_next_deadline(const scheduler_t *sched)
+{
+    return sched->count > 0 ? sched->heap[0]->deadline_ns : UINT64_MAX;
+}
+
+sched_task_t *scheduler_pop_due(scheduler_t *sched, uint64_t now_ns)
+{
+    if (sched->count == 0 || sched->heap[0]->deadline_ns > now_ns) {
+        return NULL;
+    }
+
+    sched_task_t *task = sched->heap[0];
+    sched->heap[0] = sched->heap[--sched->count];
+    sift_down(sched, 0);
+    return task;
+}
+
+void scheduler_reschedule(scheduler_t *sched, sched_task_t *task, uint64_t now_ns)
+{
+    task->deadline_ns += task->period_ns;
+
+    // Skip slots missed while the task overran instead of running back to back
+    if (task->deadline_ns <= now_ns) {
+        uint64_t behind = now_ns - task->deadline_ns;
+        task->deadline_ns += (behind / task->period_ns + 1) * task->period_ns;
+    }
+    heap_push(sched, task);
+}
+
+bool scheduler_expedite(scheduler_t *sched, sched_task_t *task, uint64_t now_ns)
+{
+    for (size_t i = 0; i < sched->count; i++) {
+        if (sched->heap[i] != task) continue;
+
+        if (task->deadline_ns > now_ns) {
+            task->deadline_ns = now_ns;
+            sift_up(sched, i);
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,49 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * scheduler.h - Deadline scheduler for periodic tasks
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCHED_MAX_TASKS 32  // Maximum number of scheduled tasks
+
+// A periodic task; storage is owned by the caller
+typedef struct {
+    const char *name;           // Task name for logging
+    uint64_t period_ns;         // Interval between runs
+    uint64_t deadline_ns;       // Next due time (CLOCK_MONOTONIC)
+    uint64_t last_run_ns;       // Duration of the most recent run
+} sched_task_t;
+
+// Min-heap of tasks ordered by deadline
+typedef struct {
+    sched_task_t *heap[SCHED_MAX_TASKS];
+    size_t count;
+} scheduler_t;
+
+// Reset the scheduler to empty
+void scheduler_init(scheduler_t *sched);
+
+// Add a task, first due at deadline_ns
+bool scheduler_add(scheduler_t *sched, sched_task_t *task, uint64_t deadline_ns);
+
+// Earliest deadline, or UINT64_MAX if nothing is scheduled
+uint64_t scheduler_next_deadline(const scheduler_t *sched);
+
+// Remove and return the earliest task if it is due, otherwise NULL
+sched_task_t *scheduler_pop_due(scheduler_t *sched, uint64_t now_ns);
+
+// Advance a popped task to its next slot on the period grid and re-add it
+void scheduler_reschedule(scheduler_t *sched, sched_task_t *task, uint64_t now_ns);
+
+// Make a scheduled task due at now_ns if it is not already; its later
+// runs follow the period grid from there
+bool scheduler_expedite(scheduler_t *sched, sched_task_t *task, uint64_t now_ns);
+
+#endif /* SCHEDULER_H */
@@ -0,0 +1,189 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * thread_pool.c - Fork-join worker pool implementation
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <string.h>
+
+#include "thread_pool.h"
+#include "error_handler.h"
+
+#define RANGE_PACK(b, e) (((uint64_t)(b) << 32) | (uint32_t)(e))
+#define RANGE_BEGIN(r)   ((uint32_t)((r) >> 32))
+#define RANGE_END(r)     ((uint32_t)(r))
+
+// Owner side: take up to THREAD_POOL_CHUNK items from the end of its range
+static bool deque_take(pool_deque_t *dq, uint32_t *begin, uint32_t *end)
+{
+    uint64_t old = atomic_load_explicit(&dq->range, memory_order_acquire);
+
+    for (;;) {
+        uint32_t b = RANGE_BEGIN(old);
+        uint32_t e = RANGE_END(old);
+        if (b >= e) return false;
+
+        uint32_t nb = e - b > THREAD_POOL_CHUNK ? e - THREAD_POOL_CHUNK : b;
+        if (atomic_compare_exchange_weak_explicit(&dq->range, &old, RANGE_PACK(b, nb),
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            *begin = nb;
+            *end = e;
+            return true;
+        }
+    }
+}
+
+// Thief side: take the first half of another worker's remaining range
+static bool deque_steal(pool_deque_t *dq, uint32_t *begin, uint32_t *end)
+{
+    uint64_t old = atomic_load_explicit(&dq->range, memory_order_acquire);
+
+    for (;;) {
+        uint32_t b = RANGE_BEGIN(old);
+        uint32_t e = RANGE_END(old);
+        if (b >= e) return false;
+
+        uint32_t n = (e - b + 1) / 2;
+        if (atomic_compare_exchange_weak_explicit(&dq->range, &old, RANGE_PACK(b + n, e),
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            *begin = b;
+            *end = b + n;
+            return true;
+        }
+    }
+}
+
+// Drain the worker's own range, then steal until every range is empty
+static void worker_drain(thread_pool_t *pool, int self)
+{
+    pool_deque_t *own = &pool->deques[self];
+    uint32_t b, e;
+
+    for (;;) {
+        while (deque_take(own, &b, &e)) {
+            for (uint32_t i = b; i < e; i++) {
+                pool->fn(pool->ctx, self, i);
+            }
+        }
+
+        bool stole = false;
+        for (int k = 1; k < pool->num_workers && !stole; k++) {
+            int victim = (self + k) % pool->num_workers;
+            if (deque_steal(&pool->deques[victim], &b, &e)) {
+                // Our range is empty, so no thief can race with this store
+                atomic_store_explicit(&own->range, RANGE_PACK(b, e), memory_order_release);
+                stole = true;
+            }
+        }
+        if (!stole) return;
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    pool_worker_t *worker = arg;
+    thread_pool_t *pool = worker->pool;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->stopping) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stopping) break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        worker_drain(pool, worker->id);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->finished);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+bool thread_pool_init(thread_pool_t *pool, int num_workers)
+{
+    memset(pool, 0, sizeof(*pool));
+    if (num_workers < 1) num_workers = 1;
+    if (num_workers > THREAD_POOL_MAX) num_workers = THREAD_POOL_MAX;
+    pool->num_workers = 1;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+
+    for (int i = 1; i < num_workers; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+
+        int err = pthread_create(&pool->threads[i], NULL, worker_main, &pool->workers[i]);
+        if (err != 0) {
+            log_error("Failed to create worker thread: %s", strerror(err));
+            thread_pool_destroy(pool);
+            return false;
+        }
+        pool->num_workers = i + 1;
+    }
+    return true;
+}
+
+void thread_pool_run(thread_pool_t *pool, size_t count, pool_item_fn fn, void *ctx)
+{
+    pool->fn = fn;
+    pool->ctx = ctx;
+
+    if (pool->num_workers == 1) {
+        for (size_t i = 0; i < count; i++) fn(ctx, 0, i);
+        return;
+    }
+
+    // Split the items into one contiguous range per worker
+    size_t per = count / pool->num_workers;
+    size_t extra = count % pool->num_workers;
+    size_t begin = 0;
+    for (int w = 0; w < pool->num_workers; w++) {
+        size_t n = per + ((size_t)w < extra ? 1 : 0);
+        atomic_store_explicit(&pool->deques[w].range, RANGE_PACK(begin, begin + n),
+                              memory_order_relaxed);
+        begin += n;
+    }
+
+    // The mutex orders the range setup before, and all results after, the work
+    pthread_mutex_lock(&pool->lock);
+    pool->active = pool->num_workers - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    worker_drain(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_destroy(thread_pool_t *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 1; i < pool->num_workers; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->finished);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    pool->num_workers = 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * thread_pool.h - Fork-join worker pool with work-stealing index ranges
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define THREAD_POOL_MAX 64          // Maximum number of workers
+#define THREAD_POOL_CHUNK 16        // Items an owner takes from its own range at once
+
+// Processes item index on behalf of worker (0 is the calling thread)
+typedef void (*pool_item_fn)(void *ctx, int worker, size_t index);
+
+/*
+ * Each worker owns a deque over a contiguous range of item indices,
+ * packed as (begin << 32 | end) in one atomic word. The owner takes
+ * chunks from the end; an idle worker steals half of another worker's
+ * remaining range from the begin side with a single CAS.
+ */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t range;
+} pool_deque_t;
+
+typedef struct thread_pool thread_pool_t;
+
+// Start argument of a helper thread
+typedef struct {
+    thread_pool_t *pool;
+    int id;
+} pool_worker_t;
+
+struct thread_pool {
+    int num_workers;                // Including the calling thread
+    pthread_t threads[THREAD_POOL_MAX];
+    pool_worker_t workers[THREAD_POOL_MAX];
+    pool_deque_t deques[THREAD_POOL_MAX];
+    pthread_mutex_t lock;           // Guards the fields below; held once per job, not per item
+    pthread_cond_t wake;            // Signalled when a job is posted or on stop
+    pthread_cond_t finished;        // Signalled when the last helper is done
+    unsigned long generation;       // Job counter
+    int active;                     // Helpers still working on the current job
+    bool stopping;
+    pool_item_fn fn;
+    void *ctx;
+};
+
+// Start num_workers - 1 helper threads; the caller acts as worker 0
+bool thread_pool_init(thread_pool_t *pool, int num_workers);
+
+// Run fn over indices [0, count) and return once every item is done
+void thread_pool_run(thread_pool_t *pool, size_t count, pool_item_fn fn, void *ctx);
+
+// Stop and join the helper threads
+void thread_pool_destroy(thread_pool_t *pool);
+
+#endif /* THREAD_POOL_H */
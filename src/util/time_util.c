@@ -0,0 +1,29 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * time_util.c - Monotonic clock helpers
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "time_util.h"
+
+uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t seconds_to_ns(double seconds)
+{
+    return seconds > 0.0 ? (uint64_t)(seconds * NSEC_PER_SEC) : 0;
+}
+
+struct timespec ns_to_timespec(uint64_t ns)
+{
+    struct timespec ts = {
+        .tv_sec = (time_t)(ns / NSEC_PER_SEC),
+        .tv_nsec = (long)(ns % NSEC_PER_SEC)
+    };
+    return ts;
+}
@@ -0,0 +1,24 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * time_util.h - Monotonic clock helpers
+ */
+
+#ifndef TIME_UTIL_H
+#define TIME_UTIL_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define NSEC_PER_SEC 1000000000ULL
+
+// Current CLOCK_MONOTONIC time in nanoseconds
+uint64_t monotonic_ns(void);
+
+// Convert seconds to nanoseconds
+uint64_t seconds_to_ns(double seconds);
+
+// Convert nanoseconds to a timespec
+struct timespec ns_to_timespec(uint64_t ns);
+
+#endif /* TIME_UTIL_H */
@@ -0,0 +1,49 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * triple_buffer.c - Lock-free triple buffer implementation
+ */
+
+#include "triple_buffer.h"
+
+// Set on the middle index when it holds data the reader has not seen
+#define TB_FRESH      0x4u
+#define TB_INDEX_MASK 0x3u
+
+void triple_buffer_init(triple_buffer_t *tb)
+{
+    tb->front = 0;
+    atomic_init(&tb->middle, 1);
+    tb->back = 2;
+}
+
+unsigned int triple_buffer_write_index(const triple_buffer_t *tb)
+{
+    return tb->back;
+}
+
+void triple_buffer_publish(triple_buffer_t *tb)
+{
+    // Release makes the slot contents visible before the index swap
+    unsigned int prev = atomic_exchange_explicit(&tb->middle, tb->back | TB_FRESH,
+                                                 memory_order_acq_rel);
+    tb->back = prev & TB_INDEX_MASK;
+}
+
+bool triple_buffer_update(triple_buffer_t *tb)
+{
+    if (!(atomic_load_explicit(&tb->middle, memory_order_relaxed) & TB_FRESH)) {
+        return false;
+    }
+
+    // Acquire pairs with the writer's release in triple_buffer_publish()
+    unsigned int prev = atomic_exchange_explicit(&tb->middle, tb->front,
+                                                 memory_order_acq_rel);
+    tb->front = prev & TB_INDEX_MASK;
+    return true;
+}
+
+unsigned int triple_buffer_read_index(const triple_buffer_t *tb)
+{
+    return tb->front;
+}
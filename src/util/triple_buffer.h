@@ -0,0 +1,40 @@
+/**
+ * sysmon - Interactive System Monitor
+ * 
+ * triple_buffer.h - Lock-free single-producer/single-consumer triple buffer
+ */
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/*
+ * Only slot indices are managed here; the caller owns an array of three
+ * slots. The writer always fills the back slot, the reader always reads
+ * the front slot, and the two swap through the shared middle slot, so
+ * neither side ever waits on the other.
+ */
+typedef struct {
+    atomic_uint middle;     // Shared slot index, with the fresh flag
+    unsigned int back;      // Writer-owned slot index
+    unsigned int front;     // Reader-owned slot index
+} triple_buffer_t;
+
+// Reset slot ownership
+void triple_buffer_init(triple_buffer_t *tb);
+
+// Slot the writer should fill next
+unsigned int triple_buffer_write_index(const triple_buffer_t *tb);
+
+// Publish the back slot and take ownership of the previous middle slot
+void triple_buffer_publish(triple_buffer_t *tb);
+
+// Swap in the newest published slot; returns false if nothing new
+bool triple_buffer_update(triple_buffer_t *tb);
+
+// Slot the reader currently owns
+unsigned int triple_buffer_read_index(const triple_buffer_t *tb);
+
+#endif /* TRIPLE_BUFFER_H */